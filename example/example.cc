@@ -48,8 +48,6 @@ class PurplePanel : public xpp::ui::XPanel {
       this->AddComponent(std::make_unique<xpp::ui::XButton>(ss.str()));
     }
   }
-
-  void Paint(xpp::ui::Graphics* g) override { xpp::ui::XPanel::Paint(g); }
 };
 
 int main() {
@@ -0,0 +1,102 @@
+// Paints an XButton over and over with operator new counting, and fails if
+// any paint after the first few touched the heap. Only C++ allocations are
+// counted; whatever Xlib mallocs for itself is not.
+//
+// Draws straight to the server. A recording Graphics, as used when the
+// window is pipelined or rasterizes in software, copies every DrawText
+// string into its display list and so still allocates.
+
+#include <atomic>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+#include "../ui/button.h"
+#include "../ui/frame_arena.h"
+#include "../ui/graphics.h"
+#include "../ui/look_and_feel.h"
+#include "../ui/render_context.h"
+
+namespace {
+
+std::atomic<uint64_t> allocations = 0;
+
+constexpr int kWarmupFrames = 4;
+constexpr int kCountedFrames = 1000;
+
+}  // namespace
+
+// The array, nothrow and sized forms all end up in these.
+void* operator new(size_t size) {
+  allocations.fetch_add(1, std::memory_order_relaxed);
+  if (void* block = std::malloc(size ? size : 1))
+    return block;
+  throw std::bad_alloc();
+}
+
+void* operator new(size_t size, std::align_val_t alignment) {
+  allocations.fetch_add(1, std::memory_order_relaxed);
+  const size_t align = static_cast<size_t>(alignment);
+  const size_t rounded = (size + align - 1) & ~(align - 1);
+  if (void* block = std::aligned_alloc(align, rounded))
+    return block;
+  throw std::bad_alloc();
+}
+
+void operator delete(void* block) noexcept {
+  std::free(block);
+}
+
+void operator delete(void* block, std::align_val_t) noexcept {
+  std::free(block);
+}
+
+int main() {
+  using namespace xpp;
+
+  auto display = xlib::XDisplay::Create();
+  auto root = display->XRootWindow(display->XDefaultScreen());
+  const XVisualInfo& vinfo = display->GetARGBVisual();
+  const gfx::Rect size = {400, 70};
+
+  auto colormap = root->XCreateColormap(vinfo.visual, AllocNone);
+  XSetWindowAttributes attribs = {};
+  attribs.colormap = colormap->colormap();
+  auto window = root->XCreateWindow(
+      0, 0, size.width, size.height, /*border_width=*/0, vinfo.depth,
+      InputOutput, vinfo.visual, CWColormap | CWBorderPixel | CWBackPixel,
+      &attribs);
+  auto laf = std::make_shared<ui::LookAndFeel>();
+  ui::RenderContext context(window->XCreateGC(colormap), colormap, laf,
+                            window, vinfo.depth,
+                            std::make_shared<ui::LookAndFeel::FontCache>());
+
+  ui::XButton button("Allocation free");
+  ui::FrameArena arena;
+  // Every state, since each one resolves its own colors.
+  auto paint = [&] {
+    ui::FrameArena::Scope frame(&arena);
+    ui::Graphics graphics(&context, size);
+    button.Exit();
+    button.Paint(&graphics);
+    button.Enter();
+    button.Paint(&graphics);
+    button.Press();
+    button.Paint(&graphics);
+    graphics.Flush();
+  };
+
+  // Fonts, pixels, shaped text and the arena itself fill up here.
+  for (int i = 0; i < kWarmupFrames; i++)
+    paint();
+
+  const uint64_t before = allocations.load();
+  for (int i = 0; i < kCountedFrames; i++)
+    paint();
+  const uint64_t counted = allocations.load() - before;
+
+  printf("%" PRIu64 " allocations over %d frames of XButton::Paint\n",
+         counted, kCountedFrames);
+  return counted ? 1 : 0;
+}
@@ -1,7 +1,9 @@
 #pragma once
 
+#include <algorithm>
 #include <cstdint>
 #include <iostream>
+#include <tuple>
 
 #include "base/check.h"
 
@@ -10,7 +12,7 @@ namespace xpp::gfx {
 namespace {
 
 template <typename Numeric>
-Numeric hue2rgb(Numeric p, Numeric q, Numeric t) {
+constexpr Numeric hue2rgb(Numeric p, Numeric q, Numeric t) {
   if (t < 0)
     t += 1;
   if (t > 1)
@@ -25,6 +27,18 @@ Numeric hue2rgb(Numeric p, Numeric q, Numeric t) {
   return p;
 }
 
+// std::abs and std::fmod are not constexpr until C++23.
+template <typename Numeric>
+constexpr Numeric cabs(Numeric value) {
+  return value < 0 ? -value : value;
+}
+
+template <typename Numeric>
+constexpr Numeric cfmod(Numeric value, Numeric divisor) {
+  auto whole = static_cast<int64_t>(value / divisor);
+  return value - divisor * static_cast<Numeric>(whole);
+}
+
 }  // namespace
 
 template <typename Depth>
@@ -33,43 +47,48 @@ class ColorImpl {
   using Int = typename Depth::Int;
   using Float = typename Depth::Float;
 
-  static ColorImpl BLACK;
-  static ColorImpl GRAY1;
-  static ColorImpl GRAY2;
-  static ColorImpl GRAY3;
-  static ColorImpl GRAY4;
-  static ColorImpl GRAY5;
-  static ColorImpl GRAY6;
-  static ColorImpl GRAY7;
-  static ColorImpl GRAY8;
-  static ColorImpl GRAY9;
-  static ColorImpl WHITE;
-  static ColorImpl RED;
-  static ColorImpl ORANGE;
-  static ColorImpl YELLOW;
-  static ColorImpl GREEN;
-  static ColorImpl MINT;
-  static ColorImpl TEAL;
-  static ColorImpl CYAN;
-  static ColorImpl BLUE;
-  static ColorImpl INDIGO;
-  static ColorImpl PURPLE;
-  static ColorImpl PINK;
-  static ColorImpl BROWN;
-
-  bool operator<(const ColorImpl& other) const {
+  static const ColorImpl BLACK;
+  static const ColorImpl GRAY1;
+  static const ColorImpl GRAY2;
+  static const ColorImpl GRAY3;
+  static const ColorImpl GRAY4;
+  static const ColorImpl GRAY5;
+  static const ColorImpl GRAY6;
+  static const ColorImpl GRAY7;
+  static const ColorImpl GRAY8;
+  static const ColorImpl GRAY9;
+  static const ColorImpl WHITE;
+  static const ColorImpl RED;
+  static const ColorImpl ORANGE;
+  static const ColorImpl YELLOW;
+  static const ColorImpl GREEN;
+  static const ColorImpl MINT;
+  static const ColorImpl TEAL;
+  static const ColorImpl CYAN;
+  static const ColorImpl BLUE;
+  static const ColorImpl INDIGO;
+  static const ColorImpl PURPLE;
+  static const ColorImpl PINK;
+  static const ColorImpl BROWN;
+
+  constexpr bool operator<(const ColorImpl& other) const {
     return Index() < other.Index();
   }
 
-  Int Index() const {
-    return R + (G * Depth::Max) + (B * Depth::Max * Depth::Max);
+  // Unique per color. Each channel gets its own Depth::Max + 1 sized digit.
+  constexpr uint64_t Index() const {
+    constexpr uint64_t kRadix = uint64_t{Depth::Max} + 1;
+    return uint64_t{R} + (uint64_t{G} * kRadix) +
+           (uint64_t{B} * kRadix * kRadix);
   }
 
   ~ColorImpl() = default;
 
-  static ColorImpl RGB(Int R, Int G, Int B) { return ColorImpl(R, G, B); }
+  static constexpr ColorImpl RGB(Int R, Int G, Int B) {
+    return ColorImpl(R, G, B);
+  }
 
-  static ColorImpl CMYK(Int C, Int M, Int Y, Int K) {
+  static constexpr ColorImpl CMYK(Int C, Int M, Int Y, Int K) {
     CHECK((C >= 0 && M >= 0 && Y >= 0 && K >= 0));
     CHECK((C <= 100 && M <= 100 && Y <= 100 && K <= 100));
 
@@ -80,15 +99,15 @@ class ColorImpl {
     return ColorImpl(R, G, B);
   }
 
-  static ColorImpl HSV(Float H, Float S, Float V) {
-    CHECK(H > 360 || H < 0 || S > 100 || S < 0 || V > 100 || V < 0);
+  static constexpr ColorImpl HSV(Float H, Float S, Float V) {
+    CHECK(H <= 360 && H >= 0 && S <= 100 && S >= 0 && V <= 100 && V >= 0);
 
     Float s = S / 100;
     Float v = V / 100;
     Float C = s * v;
-    Float X = C * (1 - std::abs(fmod(H / 60.0, 2) - 1));
+    Float X = C * (1 - cabs<Float>(cfmod<Float>(H / 60, 2) - 1));
     Float m = v - C;
-    Float r, g, b;
+    Float r = 0, g = 0, b = 0;
     if (H >= 0 && H < 60) {
       r = C, g = X, b = 0;
     } else if (H >= 60 && H < 120) {
@@ -108,7 +127,7 @@ class ColorImpl {
     return ColorImpl(R, G, B);
   }
 
-  static ColorImpl HSL(Float H, Float S, Float L) {
+  static constexpr ColorImpl HSL(Float H, Float S, Float L) {
     Float R = 0;
     Float G = 0;
     Float B = 0;
@@ -124,28 +143,35 @@ class ColorImpl {
     return ColorImpl(R, G, B);
   }
 
-  static ColorImpl Black() { return ColorImpl(0, 0, 0); }
+  static constexpr ColorImpl Black() { return ColorImpl(0, 0, 0); }
 
-  static ColorImpl White() {
+  static constexpr ColorImpl White() {
     return ColorImpl(Depth::Max, Depth::Max, Depth::Max);
   }
 
-  uint16_t red() const { return static_cast<uint16_t>(R) * Depth::Scale; }
+  constexpr uint16_t red() const {
+    return static_cast<uint16_t>(R) * Depth::Scale;
+  }
 
-  uint16_t green() const { return static_cast<uint16_t>(G) * Depth::Scale; }
+  constexpr uint16_t green() const {
+    return static_cast<uint16_t>(G) * Depth::Scale;
+  }
 
-  uint16_t blue() const { return static_cast<uint16_t>(B) * Depth::Scale; }
+  constexpr uint16_t blue() const {
+    return static_cast<uint16_t>(B) * Depth::Scale;
+  }
 
-  std::tuple<Float, Float, Float> GetHSL() const {
-    Float r = (Float)R / Depth::Max;
-    Float g = (Float)G / Depth::Max;
-    Float b = (Float)B / Depth::Max;
+  constexpr std::tuple<Float, Float, Float> GetHSL() const {
+    Float r = static_cast<Float>(R) / Depth::Max;
+    Float g = static_cast<Float>(G) / Depth::Max;
+    Float b = static_cast<Float>(B) / Depth::Max;
 
     Float max = std::max(std::max(r, g), b);
     Float min = std::min(std::min(r, g), b);
 
-    Float H, S, L;
-    H = S = L = (max + min) / 2;
+    Float L = (max + min) / 2;
+    Float H = L;
+    Float S = L;
 
     if (max == min) {
       H = S = 0;
@@ -163,37 +189,36 @@ class ColorImpl {
       H /= 6;
     }
 
-    return std::tie(H, S, L);
+    return std::make_tuple(H, S, L);
   }
 
-  ColorImpl Darker(Float value = 0.9) const {
+  constexpr ColorImpl Darker(Float value = 0.9) const {
     auto hsl = GetHSL();
     return ColorImpl::HSL(std::get<0>(hsl), std::get<1>(hsl),
                           std::get<2>(hsl) * value);
   }
 
-  ColorImpl Lighter(Float value = 0.9) const {
+  constexpr ColorImpl Lighter(Float value = 0.9) const {
     auto hsl = GetHSL();
     Float lum = 1.0 - std::get<2>(hsl);
     return ColorImpl::HSL(std::get<0>(hsl), std::get<1>(hsl),
                           1.0 - (lum * value));
   }
 
-  bool operator==(const ColorImpl& other) const {
+  constexpr bool operator==(const ColorImpl& other) const {
     return other.R == R && other.G == G && other.B == B;
   }
 
-  ColorImpl() : ColorImpl(0, 0, 0) {}
+  constexpr ColorImpl() : ColorImpl(0, 0, 0) {}
 
  private:
   Int R;
   Int G;
   Int B;
 
-  ColorImpl(Int R, Int G, Int B) : R(R), G(G), B(B) {
-    CHECK((R >= 0 && G >= 0 && B >= 0));
-    CHECK((R <= 255 && G <= 255 && B <= 255));
-  }
+  // Every channel value is already in range for Int, so there is nothing to
+  // check at runtime.
+  constexpr ColorImpl(Int R, Int G, Int B) : R(R), G(G), B(B) {}
 };
 
 struct Depth8 {
@@ -214,72 +239,72 @@ using Color = ColorImpl<Depth8>;
 using HDRColor = ColorImpl<Depth16>;
 
 template <typename D>
-ColorImpl<D> ColorImpl<D>::BLACK = ColorImpl<D>::RGB(28, 28, 30);
+constexpr ColorImpl<D> ColorImpl<D>::BLACK = ColorImpl<D>::RGB(28, 28, 30);
 
 template <typename D>
-ColorImpl<D> ColorImpl<D>::GRAY1 = ColorImpl<D>::RGB(44, 44, 46);
+constexpr ColorImpl<D> ColorImpl<D>::GRAY1 = ColorImpl<D>::RGB(44, 44, 46);
 
 template <typename D>
-ColorImpl<D> ColorImpl<D>::GRAY2 = ColorImpl<D>::RGB(58, 58, 60);
+constexpr ColorImpl<D> ColorImpl<D>::GRAY2 = ColorImpl<D>::RGB(58, 58, 60);
 
 template <typename D>
-ColorImpl<D> ColorImpl<D>::GRAY3 = ColorImpl<D>::RGB(72, 72, 74);
+constexpr ColorImpl<D> ColorImpl<D>::GRAY3 = ColorImpl<D>::RGB(72, 72, 74);
 
 template <typename D>
-ColorImpl<D> ColorImpl<D>::GRAY4 = ColorImpl<D>::RGB(99, 99, 102);
+constexpr ColorImpl<D> ColorImpl<D>::GRAY4 = ColorImpl<D>::RGB(99, 99, 102);
 
 template <typename D>
-ColorImpl<D> ColorImpl<D>::GRAY5 = ColorImpl<D>::RGB(142, 142, 147);
+constexpr ColorImpl<D> ColorImpl<D>::GRAY5 = ColorImpl<D>::RGB(142, 142, 147);
 
 template <typename D>
-ColorImpl<D> ColorImpl<D>::GRAY6 = ColorImpl<D>::RGB(174, 174, 178);
+constexpr ColorImpl<D> ColorImpl<D>::GRAY6 = ColorImpl<D>::RGB(174, 174, 178);
 
 template <typename D>
-ColorImpl<D> ColorImpl<D>::GRAY7 = ColorImpl<D>::RGB(199, 199, 204);
+constexpr ColorImpl<D> ColorImpl<D>::GRAY7 = ColorImpl<D>::RGB(199, 199, 204);
 
 template <typename D>
-ColorImpl<D> ColorImpl<D>::GRAY8 = ColorImpl<D>::RGB(209, 209, 214);
+constexpr ColorImpl<D> ColorImpl<D>::GRAY8 = ColorImpl<D>::RGB(209, 209, 214);
 
 template <typename D>
-ColorImpl<D> ColorImpl<D>::GRAY9 = ColorImpl<D>::RGB(229, 229, 234);
+constexpr ColorImpl<D> ColorImpl<D>::GRAY9 = ColorImpl<D>::RGB(229, 229, 234);
 
 template <typename D>
-ColorImpl<D> ColorImpl<D>::WHITE = ColorImpl<D>::RGB(242, 242, 247);
+constexpr ColorImpl<D> ColorImpl<D>::WHITE = ColorImpl<D>::RGB(242, 242, 247);
 
 template <typename D>
-ColorImpl<D> ColorImpl<D>::RED = ColorImpl<D>::RGB(255, 59, 48);
+constexpr ColorImpl<D> ColorImpl<D>::RED = ColorImpl<D>::RGB(255, 59, 48);
 
 template <typename D>
-ColorImpl<D> ColorImpl<D>::ORANGE = ColorImpl<D>::RGB(255, 149, 0);
+constexpr ColorImpl<D> ColorImpl<D>::ORANGE = ColorImpl<D>::RGB(255, 149, 0);
 
 template <typename D>
-ColorImpl<D> ColorImpl<D>::YELLOW = ColorImpl<D>::RGB(255, 204, 0);
+constexpr ColorImpl<D> ColorImpl<D>::YELLOW = ColorImpl<D>::RGB(255, 204, 0);
 
 template <typename D>
-ColorImpl<D> ColorImpl<D>::GREEN = ColorImpl<D>::RGB(52, 199, 89);
+constexpr ColorImpl<D> ColorImpl<D>::GREEN = ColorImpl<D>::RGB(52, 199, 89);
 
 template <typename D>
-ColorImpl<D> ColorImpl<D>::MINT = ColorImpl<D>::RGB(0, 199, 190);
+constexpr ColorImpl<D> ColorImpl<D>::MINT = ColorImpl<D>::RGB(0, 199, 190);
 
 template <typename D>
-ColorImpl<D> ColorImpl<D>::TEAL = ColorImpl<D>::RGB(48, 176, 199);
+constexpr ColorImpl<D> ColorImpl<D>::TEAL = ColorImpl<D>::RGB(48, 176, 199);
 
 template <typename D>
-ColorImpl<D> ColorImpl<D>::CYAN = ColorImpl<D>::RGB(50, 173, 230);
+constexpr ColorImpl<D> ColorImpl<D>::CYAN = ColorImpl<D>::RGB(50, 173, 230);
 
 template <typename D>
-ColorImpl<D> ColorImpl<D>::BLUE = ColorImpl<D>::RGB(0, 122, 255);
+constexpr ColorImpl<D> ColorImpl<D>::BLUE = ColorImpl<D>::RGB(0, 122, 255);
 
 template <typename D>
-ColorImpl<D> ColorImpl<D>::INDIGO = ColorImpl<D>::RGB(88, 86, 214);
+constexpr ColorImpl<D> ColorImpl<D>::INDIGO = ColorImpl<D>::RGB(88, 86, 214);
 
 template <typename D>
-ColorImpl<D> ColorImpl<D>::PURPLE = ColorImpl<D>::RGB(175, 82, 222);
+constexpr ColorImpl<D> ColorImpl<D>::PURPLE = ColorImpl<D>::RGB(175, 82, 222);
 
 template <typename D>
-ColorImpl<D> ColorImpl<D>::PINK = ColorImpl<D>::RGB(255, 45, 85);
+constexpr ColorImpl<D> ColorImpl<D>::PINK = ColorImpl<D>::RGB(255, 45, 85);
 
 template <typename D>
-ColorImpl<D> ColorImpl<D>::BROWN = ColorImpl<D>::RGB(162, 132, 94);
+constexpr ColorImpl<D> ColorImpl<D>::BROWN = ColorImpl<D>::RGB(162, 132, 94);
 
 }  // namespace xpp::gfx
@@ -0,0 +1,390 @@
+#include "color_batch.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace xpp::gfx {
+
+namespace {
+
+constexpr size_t kChunk = 64;
+
+// Up to kChunk colors split into one array per component, so that a kernel
+// always works on whole vectors of a single component.
+struct Planes {
+  alignas(32) float x[kChunk];
+  alignas(32) float y[kChunk];
+  alignas(32) float z[kChunk];
+};
+
+// Alias templates drop vector_size, so the types have to come from a class.
+template <size_t Lanes>
+struct Vectors {
+  typedef float Float __attribute__((vector_size(Lanes * sizeof(float))));
+  typedef int32_t Int __attribute__((vector_size(Lanes * sizeof(int32_t))));
+};
+
+template <size_t Lanes>
+using FloatVec = typename Vectors<Lanes>::Float;
+
+template <size_t Lanes>
+using IntVec = typename Vectors<Lanes>::Int;
+
+// The kernels are written once against the compiler's generic vectors and
+// force-inlined into one entry point per instruction set, whose target
+// attribute decides what they compile to. Nothing is ever passed between
+// them in registers, so the -Wpsabi warning about wide vector arguments
+// doesn't apply. It is reported at the end of the file, so it can't be
+// popped again.
+#pragma GCC diagnostic ignored "-Wpsabi"
+
+#define ALWAYS_INLINE [[gnu::always_inline]] inline
+
+template <typename F>
+ALWAYS_INLINE F Load(const float* from) {
+  F result;
+  memcpy(&result, from, sizeof(F));
+  return result;
+}
+
+template <typename F>
+ALWAYS_INLINE void Store(float* to, F value) {
+  memcpy(to, &value, sizeof(F));
+}
+
+template <typename F>
+ALWAYS_INLINE F Splat(float value) {
+  return F{} + value;
+}
+
+template <typename F>
+ALWAYS_INLINE F Max(F a, F b) {
+  return a > b ? a : b;
+}
+
+template <typename F>
+ALWAYS_INLINE F Min(F a, F b) {
+  return a < b ? a : b;
+}
+
+// Same branches as ColorImpl::GetHSL, which the HSV conversion shares.
+template <typename F>
+ALWAYS_INLINE F Hue(F r, F g, F b, F max, F delta) {
+  F d = delta == 0 ? Splat<F>(1) : delta;
+  F hue = max == r   ? (g - b) / d + (g < b ? Splat<F>(6) : F{})
+          : max == g ? (b - r) / d + 2
+                     : (r - g) / d + 4;
+  return delta == 0 ? F{} : hue / 6;
+}
+
+// Vector version of hue2rgb in color.h.
+template <typename F>
+ALWAYS_INLINE F HueToChannel(F p, F q, F t) {
+  t = t < 0 ? t + 1 : t;
+  t = t > 1 ? t - 1 : t;
+  return t < 1.f / 6   ? p + (q - p) * 6 * t
+         : t < 1.f / 2 ? q
+         : t < 2.f / 3 ? p + (q - p) * (2.f / 3 - t) * 6
+                       : p;
+}
+
+template <size_t Lanes>
+ALWAYS_INLINE void RGBToHSLKernel(Planes* planes) {
+  using F = FloatVec<Lanes>;
+  for (size_t i = 0; i < kChunk; i += Lanes) {
+    F r = Load<F>(planes->x + i);
+    F g = Load<F>(planes->y + i);
+    F b = Load<F>(planes->z + i);
+    F max = Max(Max(r, g), b);
+    F min = Min(Min(r, g), b);
+    F delta = max - min;
+    F l = (max + min) / 2;
+    F s = l > 0.5f ? delta / (2 - max - min) : delta / (max + min);
+    Store(planes->x + i, Hue(r, g, b, max, delta));
+    Store(planes->y + i, delta == 0 ? F{} : s);
+    Store(planes->z + i, l);
+  }
+}
+
+template <size_t Lanes>
+ALWAYS_INLINE void HSLToRGBKernel(Planes* planes) {
+  using F = FloatVec<Lanes>;
+  for (size_t i = 0; i < kChunk; i += Lanes) {
+    F h = Load<F>(planes->x + i);
+    F s = Load<F>(planes->y + i);
+    F l = Load<F>(planes->z + i);
+    F q = l < 0.5f ? l * (1 + s) : l + s - l * s;
+    F p = 2 * l - q;
+    F r = HueToChannel(p, q, h + 1.f / 3);
+    F g = HueToChannel(p, q, h);
+    F b = HueToChannel(p, q, h - 1.f / 3);
+    Store(planes->x + i, s == 0 ? l : r);
+    Store(planes->y + i, s == 0 ? l : g);
+    Store(planes->z + i, s == 0 ? l : b);
+  }
+}
+
+template <size_t Lanes>
+ALWAYS_INLINE void RGBToHSVKernel(Planes* planes) {
+  using F = FloatVec<Lanes>;
+  for (size_t i = 0; i < kChunk; i += Lanes) {
+    F r = Load<F>(planes->x + i);
+    F g = Load<F>(planes->y + i);
+    F b = Load<F>(planes->z + i);
+    F max = Max(Max(r, g), b);
+    F delta = max - Min(Min(r, g), b);
+    Store(planes->x + i, Hue(r, g, b, max, delta));
+    Store(planes->y + i, max == 0 ? F{} : delta / (max == 0 ? 1 : max));
+    Store(planes->z + i, max);
+  }
+}
+
+// Same sextants as ColorImpl::HSV, with the hue in [0, 1].
+template <size_t Lanes>
+ALWAYS_INLINE void HSVToRGBKernel(Planes* planes) {
+  using F = FloatVec<Lanes>;
+  using I = IntVec<Lanes>;
+  for (size_t i = 0; i < kChunk; i += Lanes) {
+    F h = Load<F>(planes->x + i) * 6;
+    F s = Load<F>(planes->y + i);
+    F v = Load<F>(planes->z + i);
+    F c = s * v;
+    // The hue is never negative, so truncating is the same as flooring.
+    I sextant_pair = __builtin_convertvector(h / 2, I);
+    F mod = h - 2 * __builtin_convertvector(sextant_pair, F);
+    F distance = mod - 1;
+    F x = c * (1 - (distance < 0 ? -distance : distance));
+    F m = v - c;
+    F r = h < 1 ? c : h < 2 ? x : h < 4 ? F{} : h < 5 ? x : c;
+    F g = h < 1 ? x : h < 3 ? c : h < 4 ? x : F{};
+    F b = h < 2 ? F{} : h < 3 ? x : h < 5 ? c : x;
+    Store(planes->x + i, r + m);
+    Store(planes->y + i, g + m);
+    Store(planes->z + i, b + m);
+  }
+}
+
+// Scales every component and clamps it to [0, limit], ready to be truncated.
+template <size_t Lanes>
+ALWAYS_INLINE void QuantizeKernel(Planes* planes,
+                                  float scale,
+                                  float bias,
+                                  float limit) {
+  using F = FloatVec<Lanes>;
+  for (float* plane : {planes->x, planes->y, planes->z}) {
+    for (size_t i = 0; i < kChunk; i += Lanes) {
+      F value = Load<F>(plane + i) * scale + bias;
+      Store(plane + i, Min(Max(value, F{}), Splat<F>(limit)));
+    }
+  }
+}
+
+struct Kernels {
+  ColorBatchIsa isa;
+  void (*rgb_to_hsl)(Planes*);
+  void (*hsl_to_rgb)(Planes*);
+  void (*rgb_to_hsv)(Planes*);
+  void (*hsv_to_rgb)(Planes*);
+  void (*quantize)(Planes*, float, float, float);
+};
+
+#define DEFINE_KERNELS(ns, lanes, ...)                                  \
+  namespace ns {                                                        \
+  __VA_ARGS__ void RGBToHSL(Planes* planes) {                           \
+    RGBToHSLKernel<lanes>(planes);                                      \
+  }                                                                     \
+  __VA_ARGS__ void HSLToRGB(Planes* planes) {                           \
+    HSLToRGBKernel<lanes>(planes);                                      \
+  }                                                                     \
+  __VA_ARGS__ void RGBToHSV(Planes* planes) {                           \
+    RGBToHSVKernel<lanes>(planes);                                      \
+  }                                                                     \
+  __VA_ARGS__ void HSVToRGB(Planes* planes) {                           \
+    HSVToRGBKernel<lanes>(planes);                                      \
+  }                                                                     \
+  __VA_ARGS__ void Quantize(Planes* planes, float s, float b, float l) { \
+    QuantizeKernel<lanes>(planes, s, b, l);                             \
+  }                                                                     \
+  }
+
+DEFINE_KERNELS(scalar, 1)
+constexpr Kernels kScalarKernels = {
+    ColorBatchIsa::kScalar, scalar::RGBToHSL, scalar::HSLToRGB,
+    scalar::RGBToHSV,       scalar::HSVToRGB, scalar::Quantize,
+};
+
+#if defined(__x86_64__) || defined(__i386__)
+DEFINE_KERNELS(sse41, 4, __attribute__((target("sse4.1"))))
+constexpr Kernels kSSE41Kernels = {
+    ColorBatchIsa::kSSE41, sse41::RGBToHSL, sse41::HSLToRGB,
+    sse41::RGBToHSV,       sse41::HSVToRGB, sse41::Quantize,
+};
+
+DEFINE_KERNELS(avx2, 8, __attribute__((target("avx2"))))
+constexpr Kernels kAVX2Kernels = {
+    ColorBatchIsa::kAVX2, avx2::RGBToHSL, avx2::HSLToRGB,
+    avx2::RGBToHSV,       avx2::HSVToRGB, avx2::Quantize,
+};
+#endif
+
+#undef DEFINE_KERNELS
+#undef ALWAYS_INLINE
+
+const Kernels& SelectKernels() {
+#if defined(__x86_64__) || defined(__i386__)
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2"))
+    return kAVX2Kernels;
+  if (__builtin_cpu_supports("sse4.1"))
+    return kSSE41Kernels;
+#endif
+  return kScalarKernels;
+}
+
+const Kernels& GetKernels() {
+  static const Kernels& kernels = SelectKernels();
+  return kernels;
+}
+
+// Splits |in| into chunks, has |load| fill in column i of the planes for
+// each element, runs |kernel| over the whole chunk and has |store| read the
+// results back out. Columns past the end of a short chunk hold stale but
+// harmless values from the chunk before.
+template <typename In, typename Out, typename LoadFn, typename KernelFn,
+          typename StoreFn>
+void Convert(const In* in,
+             Out* out,
+             size_t count,
+             LoadFn load,
+             KernelFn kernel,
+             StoreFn store) {
+  Planes planes = {};
+  for (size_t start = 0; start < count; start += kChunk) {
+    size_t length = std::min(kChunk, count - start);
+    for (size_t i = 0; i < length; i++)
+      load(in[start + i], &planes, i);
+    kernel(&planes);
+    for (size_t i = 0; i < length; i++)
+      out[start + i] = store(planes, i);
+  }
+}
+
+void LoadColor(const Color& color, Planes* planes, size_t i) {
+  planes->x[i] = static_cast<float>(color.red() / 257) / 255;
+  planes->y[i] = static_cast<float>(color.green() / 257) / 255;
+  planes->z[i] = static_cast<float>(color.blue() / 257) / 255;
+}
+
+Color StoreColor(const Planes& planes, size_t i) {
+  return Color::RGB(static_cast<uint8_t>(planes.x[i]),
+                    static_cast<uint8_t>(planes.y[i]),
+                    static_cast<uint8_t>(planes.z[i]));
+}
+
+// Channels come back in [0, 1]. Unlike ColorImpl, round instead of
+// truncating, so that a round trip gives back the color it started from.
+void ToColorRange(Planes* planes) {
+  GetKernels().quantize(planes, 255, 0.5f, 255);
+}
+
+}  // namespace
+
+ColorBatchIsa GetColorBatchIsa() {
+  return GetKernels().isa;
+}
+
+void RGBToHSL(const Color* in, HSL* out, size_t count) {
+  Convert(in, out, count, LoadColor, GetKernels().rgb_to_hsl,
+          [](const Planes& planes, size_t i) {
+            return HSL{planes.x[i], planes.y[i], planes.z[i]};
+          });
+}
+
+void HSLToRGB(const HSL* in, Color* out, size_t count) {
+  Convert(
+      in, out, count,
+      [](const HSL& hsl, Planes* planes, size_t i) {
+        planes->x[i] = hsl.h;
+        planes->y[i] = hsl.s;
+        planes->z[i] = hsl.l;
+      },
+      [](Planes* planes) {
+        GetKernels().hsl_to_rgb(planes);
+        ToColorRange(planes);
+      },
+      StoreColor);
+}
+
+void RGBToHSV(const Color* in, HSV* out, size_t count) {
+  Convert(in, out, count, LoadColor, GetKernels().rgb_to_hsv,
+          [](const Planes& planes, size_t i) {
+            return HSV{planes.x[i], planes.y[i], planes.z[i]};
+          });
+}
+
+void HSVToRGB(const HSV* in, Color* out, size_t count) {
+  Convert(
+      in, out, count,
+      [](const HSV& hsv, Planes* planes, size_t i) {
+        planes->x[i] = hsv.h;
+        planes->y[i] = hsv.s;
+        planes->z[i] = hsv.v;
+      },
+      [](Planes* planes) {
+        GetKernels().hsv_to_rgb(planes);
+        ToColorRange(planes);
+      },
+      StoreColor);
+}
+
+void ToHDR(const Color* in, HDRColor* out, size_t count) {
+  // red() and friends already widen by 257, which is exact.
+  for (size_t i = 0; i < count; i++)
+    out[i] = HDRColor::RGB(in[i].red(), in[i].green(), in[i].blue());
+}
+
+void FromHDR(const HDRColor* in, Color* out, size_t count) {
+  Convert(
+      in, out, count,
+      [](const HDRColor& color, Planes* planes, size_t i) {
+        planes->x[i] = color.red();
+        planes->y[i] = color.green();
+        planes->z[i] = color.blue();
+      },
+      [](Planes* planes) {
+        GetKernels().quantize(planes, 255.f / 65535, 0.5f, 255);
+      },
+      StoreColor);
+}
+
+void InterpolateHSL(Color from, Color to, Color* out, size_t count) {
+  auto [from_h, from_s, from_l] = from.GetHSL();
+  auto [to_h, to_s, to_l] = to.GetHSL();
+  if (from_s == 0)
+    from_h = to_h;
+  if (to_s == 0)
+    to_h = from_h;
+  if (to_h - from_h > 0.5f)
+    to_h -= 1;
+  else if (from_h - to_h > 0.5f)
+    to_h += 1;
+
+  const float steps = count > 1 ? static_cast<float>(count - 1) : 1;
+  Planes planes = {};
+  for (size_t start = 0; start < count; start += kChunk) {
+    size_t length = std::min(kChunk, count - start);
+    for (size_t i = 0; i < length; i++) {
+      float t = (start + i) / steps;
+      float h = from_h + (to_h - from_h) * t;
+      planes.x[i] = h < 0 ? h + 1 : h >= 1 ? h - 1 : h;
+      planes.y[i] = from_s + (to_s - from_s) * t;
+      planes.z[i] = from_l + (to_l - from_l) * t;
+    }
+    GetKernels().hsl_to_rgb(&planes);
+    ToColorRange(&planes);
+    for (size_t i = 0; i < length; i++)
+      out[start + i] = StoreColor(planes, i);
+  }
+}
+
+}  // namespace xpp::gfx
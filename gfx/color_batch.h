@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstddef>
+
+#include "color.h"
+
+namespace xpp::gfx {
+
+// Every component is scaled to [0, 1], the same as ColorImpl::GetHSL().
+struct HSL {
+  float h;
+  float s;
+  float l;
+};
+
+struct HSV {
+  float h;
+  float s;
+  float v;
+};
+
+enum class ColorBatchIsa {
+  kScalar,
+  kSSE41,
+  kAVX2,
+};
+
+// The instruction set the batch conversions below run with. It is picked
+// from the CPU the first time any of them is called.
+ColorBatchIsa GetColorBatchIsa();
+
+// Array versions of the ColorImpl conversions, |count| colors at a time.
+// Channels are rounded rather than truncated, so converting to HSL or HSV
+// and back is lossless; the scalar versions can come back one step darker.
+void RGBToHSL(const Color* in, HSL* out, size_t count);
+void HSLToRGB(const HSL* in, Color* out, size_t count);
+void RGBToHSV(const Color* in, HSV* out, size_t count);
+void HSVToRGB(const HSV* in, Color* out, size_t count);
+
+// Widening is exact; narrowing rounds to the nearest 8 bit value.
+void ToHDR(const Color* in, HDRColor* out, size_t count);
+void FromHDR(const HDRColor* in, Color* out, size_t count);
+
+// Fills |out| with |count| colors stepping evenly from |from| to |to| in HSL,
+// taking the hue the short way around the wheel. A gray endpoint borrows the
+// other endpoint's hue so that the ramp doesn't sweep through red.
+void InterpolateHSL(Color from, Color to, Color* out, size_t count);
+
+}  // namespace xpp::gfx
@@ -14,4 +14,44 @@ std::optional<Coord> InnerPosition(Box subbox, Coord coord) {
   return coord - subbox.top_left;
 }
 
+bool Contains(const Box& outer, const Box& inner) {
+  return inner.top_left.x >= outer.top_left.x &&
+         inner.top_left.y >= outer.top_left.y &&
+         inner.top_left.x + inner.size.width <=
+             outer.top_left.x + outer.size.width &&
+         inner.top_left.y + inner.size.height <=
+             outer.top_left.y + outer.size.height;
+}
+
+void Subtract(const Box& box, const Box& hole, std::pmr::vector<Box>* out) {
+  const int64_t left = box.top_left.x;
+  const int64_t top = box.top_left.y;
+  const int64_t right = left + box.size.width;
+  const int64_t bottom = top + box.size.height;
+
+  const int64_t hole_left = std::max(left, hole.top_left.x);
+  const int64_t hole_top = std::max(top, hole.top_left.y);
+  const int64_t hole_right =
+      std::min(right, hole.top_left.x + int64_t{hole.size.width});
+  const int64_t hole_bottom =
+      std::min(bottom, hole.top_left.y + int64_t{hole.size.height});
+  if (hole_left >= hole_right || hole_top >= hole_bottom) {
+    out->push_back(box);
+    return;
+  }
+
+  auto add = [out](int64_t x, int64_t y, int64_t x2, int64_t y2) {
+    if (x < x2 && y < y2) {
+      out->push_back({{x, y},
+                      {static_cast<uint32_t>(x2 - x),
+                       static_cast<uint32_t>(y2 - y)}});
+    }
+  };
+  // Full-width bands above and below, then whatever is left either side.
+  add(left, top, right, hole_top);
+  add(left, hole_bottom, right, bottom);
+  add(left, hole_top, hole_left, hole_bottom);
+  add(hole_right, hole_top, right, hole_bottom);
+}
+
 }  // namespace xpp::gfx
\ No newline at end of file
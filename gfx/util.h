@@ -1,6 +1,8 @@
 #pragma once
 
+#include <memory_resource>
 #include <optional>
+#include <vector>
 
 #include "coord.h"
 #include "rect.h"
@@ -14,4 +16,11 @@ struct Box {
 
 std::optional<Coord> InnerPosition(Box subbox, Coord coord);
 
+// Whether every pixel of |inner| is inside |outer|.
+bool Contains(const Box& outer, const Box& inner);
+
+// Appends the parts of |box| that |hole| doesn't cover to |out|, as at most
+// four boxes that don't overlap.
+void Subtract(const Box& box, const Box& hole, std::pmr::vector<Box>* out);
+
 }  // namespace xpp::gfx
\ No newline at end of file
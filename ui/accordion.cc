@@ -3,6 +3,7 @@
 #include "accordion.h"
 
 #include "button_listener.h"
+#include "frame_arena.h"
 
 namespace xpp::ui {
 
@@ -12,10 +13,10 @@ class AccordionLayout : public Layout {
  public:
   AccordionLayout(XAccordion* parent) : parent_(parent) {}
 
-  std::vector<xpp::ui::Layout::Position> DoLayout(
+  Positions DoLayout(
       std::vector<std::tuple<std::unique_ptr<XComponent>, int32_t>>& entries,
       gfx::Rect size) override {
-    std::vector<xpp::ui::Layout::Position> positions;
+    Positions positions(FrameArena::Current());
     gfx::Coord tlc = {0, 0};
     XComponent* body = nullptr;
     for (const auto& tagged : entries) {
@@ -65,24 +66,27 @@ class AccordionTitle : public XPanel {
 
   void Release() { parent_->ToggleState(); }
 
-  void Paint(xpp::ui::Graphics* g) override {
+  void PaintContents(xpp::ui::Graphics* g) override {
     if (parent_->IsOpen())
-      g->SetColor("AccordionHeaderBackgroundColorOpen");
+      g->SetColor(theme::kAccordionHeaderBackgroundColorOpen);
     else
-      g->SetColor("AccordionHeaderBackgroundColorClosed");
+      g->SetColor(theme::kAccordionHeaderBackgroundColorClosed);
     g->FillRect({0, 0}, g->GetDimensions());
 
     g->SetFontSize(size_);
     if (parent_->IsOpen())
-      g->SetColor("AccordionHeaderTextColorOpen");
+      g->SetColor(theme::kAccordionHeaderTextColorOpen);
     else
-      g->SetColor("AccordionHeaderTextColorClosed");
+      g->SetColor(theme::kAccordionHeaderTextColorClosed);
     g->DrawText({30, 20}, text_);
   }
 
   std::optional<gfx::Rect> GetPreferredSize() override {
-    int32_t length = text_.length();
-    uint32_t width = size_ * length * 2.42 + 30;
+    uint32_t width = 0;
+    if (WindowInterface* window = Window())
+      width = window->MeasureText(text_, size_).width + 60;
+    else
+      width = size_ * text_.length() * 2.42 + 30;
     return gfx::Rect{width, size_ * 4 + 40};
   }
 
@@ -105,10 +109,10 @@ XAccordion::XAccordion(std::string text, uint32_t fontsize) {
   container_ = container.get();
   title_ = title.get();
 
-  components_.push_back(std::make_tuple(
-      std::move(title), static_cast<int>(ComponentUsage::kTitle)));
-  components_.push_back(std::make_tuple(
-      std::move(container), static_cast<int>(ComponentUsage::kBody)));
+  AppendComponent(std::move(title),
+                  static_cast<int>(ComponentUsage::kTitle));
+  AppendComponent(std::move(container),
+                  static_cast<int>(ComponentUsage::kBody));
 
   layout_ = std::make_unique<AccordionLayout>(this);
 }
@@ -148,6 +152,22 @@ void XAccordion::RemoveAll() {
   container_->RemoveAll();
 }
 
+void XAccordion::ReplaceComponents(
+    size_t position,
+    size_t count,
+    std::vector<std::unique_ptr<XComponent>> components,
+    int32_t key) {
+  container_->ReplaceComponents(position, count, std::move(components), key);
+}
+
+void XAccordion::BeginUpdate() {
+  container_->BeginUpdate();
+}
+
+void XAccordion::EndUpdate() {
+  container_->EndUpdate();
+}
+
 void XAccordion::SetLayout(std::unique_ptr<Layout> layout) {
   container_->SetLayout(std::move(layout));
 }
@@ -159,6 +179,7 @@ void XAccordion::AddComponentListener(
 
 void XAccordion::ToggleState() {
   open_ = !open_;
+  InvalidateLayout();
   Repaint();
 }
 
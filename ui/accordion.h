@@ -22,6 +22,12 @@ class XAccordion : public XPanel {
   void AddComponent(std::unique_ptr<XComponent> component) override;
   void RemoveComponent(XComponent*) override;
   void RemoveAll() override;
+  void ReplaceComponents(size_t position,
+                         size_t count,
+                         std::vector<std::unique_ptr<XComponent>> components,
+                         int32_t key = 0) override;
+  void BeginUpdate() override;
+  void EndUpdate() override;
   void SetLayout(std::unique_ptr<Layout>) override;
   void AddComponentListener(std::shared_ptr<ContainerListener>) override;
 
@@ -15,21 +15,21 @@ void XButton::Paint(xpp::ui::Graphics* g) {
   XComponent::Paint(g);
   //g->SetFontSize(8);
 
-  const char* background_color = "ButtonBackground";
-  const char* text_color = "ButtonTextColor";
-  const char* border_color = "ButtonBorder";
-  const char* shadow_color = "ButtonShadow";
+  ThemeKey background_color = theme::kButtonBackground;
+  ThemeKey text_color = theme::kButtonTextColor;
+  ThemeKey border_color = theme::kButtonBorder;
+  ThemeKey shadow_color = theme::kButtonShadow;
 
   if (depressed_) {
-    background_color = "ButtonPressedBackground";
-    text_color = "ButtonPressedTextColor";
-    border_color = "ButtonPressedBorder";
-    shadow_color = "ButtonPressedShadow";
+    background_color = theme::kButtonPressedBackground;
+    text_color = theme::kButtonPressedTextColor;
+    border_color = theme::kButtonPressedBorder;
+    shadow_color = theme::kButtonPressedShadow;
   } else if (hovered_) {
-    background_color = "ButtonHoveredBackground";
-    text_color = "ButtonHoveredTextColor";
-    border_color = "ButtonHoveredBorder";
-    shadow_color = "ButtonHoveredShadow";
+    background_color = theme::kButtonHoveredBackground;
+    text_color = theme::kButtonHoveredTextColor;
+    border_color = theme::kButtonHoveredBorder;
+    shadow_color = theme::kButtonHoveredShadow;
   }
 
   g->SetColor(shadow_color);
@@ -50,7 +50,12 @@ void XButton::Paint(xpp::ui::Graphics* g) {
 }
 
 std::optional<gfx::Rect> XButton::GetPreferredSize() {
-  return gfx::Rect(content_.length() * 22 + hpadding_ * 2, 70);
+  WindowInterface* window = Window();
+  if (!window)
+    return gfx::Rect(content_.length() * 22 + hpadding_ * 2, 70);
+  gfx::Rect text =
+      window->MeasureText(content_, LookAndFeel::kDefaultFontSize);
+  return gfx::Rect(text.width + hpadding_ * 2, 70);
 }
 
 void XButton::Enter() {
@@ -2,14 +2,26 @@
 
 namespace xpp::ui {
 
-XCanvas::XCanvas(std::shared_ptr<xlib::XPixmap> pixmap, Graphics g) 
-  :pixmap_(std::move(pixmap)), g_(std::move(g)) {}
+XCanvas::XCanvas(std::shared_ptr<xlib::XPixmap> pixmap,
+                 std::unique_ptr<RenderContext> context,
+                 gfx::Rect size)
+    : pixmap_(std::move(pixmap)),
+      context_(std::move(context)),
+      g_(context_.get(), size) {}
+
+XCanvas::XCanvas(std::shared_ptr<DisplayList> recording, Graphics g)
+    : recording_(std::move(recording)), g_(std::move(g)) {}
 
 Graphics* XCanvas::GetGraphics() {
   return &g_;
 }
 
 void XCanvas::MapOnTo(Graphics* g, gfx::Coord at) {
+  if (recording_) {
+    g->DrawRecording(recording_, g_.GetDimensions(), at);
+    return;
+  }
+  g_.Flush();
   g->CopyArea(pixmap_, at);
 }
 
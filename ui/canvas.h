@@ -1,18 +1,26 @@
 #pragma once
 
 #include "../xlib/xpixmap.h"
+#include "display_list.h"
 #include "graphics.h"
 
 namespace xpp::ui {
 
 class XCanvas {
  public:
-  XCanvas(std::shared_ptr<xlib::XPixmap> pixmap, Graphics g);
+  // Draws into |pixmap| through a context of its own.
+  XCanvas(std::shared_ptr<xlib::XPixmap> pixmap,
+          std::unique_ptr<RenderContext> context,
+          gfx::Rect size);
+  XCanvas(std::shared_ptr<DisplayList> recording, Graphics g);
   Graphics* GetGraphics();
   void MapOnTo(Graphics* g, gfx::Coord at);
 
  private:
   std::shared_ptr<xlib::XPixmap> pixmap_;
+  std::shared_ptr<DisplayList> recording_;
+  // Declared before |g_|, which borrows it.
+  std::unique_ptr<RenderContext> context_;
   Graphics g_;
 };
 
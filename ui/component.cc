@@ -1,36 +1,84 @@
 #include "component.h"
 
-#include <random>
+#include <iomanip>
+#include <mutex>
 #include <sstream>
+#include <unordered_map>
 
+#include "component_arena.h"
 #include "container.h"
 
 namespace xpp::ui {
 
 namespace {
 
-std::string get_uuid() {
-  static std::random_device dev;
-  static std::mt19937 rng(dev());
+std::atomic<ComponentId> next_id{1};
 
-  std::uniform_int_distribution<int> dist(0, 15);
+// Every live component by id.
+struct Registry {
+  std::mutex mutex;
+  std::unordered_map<ComponentId, XComponent*> components;
+};
 
-  const char* v = "0123456789abcdef";
-  const bool dash[] = {0, 0, 0, 0, 1, 0, 1, 0, 1, 0, 1, 0, 0, 0, 0, 0};
-
-  std::string res;
-  for (int i = 0; i < 16; i++) {
-    if (dash[i])
-      res += "-";
-    res += v[dist(rng)];
-    res += v[dist(rng)];
-  }
-  return res;
+Registry& GetRegistry() {
+  static Registry registry;
+  return registry;
 }
 
 }  // namespace
 
-XComponent::XComponent() : uuid_(get_uuid()) {}
+XComponent* ComponentHandle::Get() const {
+  return XComponent::Find(id_);
+}
+
+XComponent::XComponent()
+    : id_(next_id.fetch_add(1, std::memory_order_relaxed)) {
+  Registry& registry = GetRegistry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  registry.components.emplace(id_, this);
+}
+
+XComponent::~XComponent() {
+  Registry& registry = GetRegistry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  registry.components.erase(id_);
+}
+
+// static
+void* XComponent::operator new(size_t size) {
+  return ComponentArena::Allocate(size, nullptr);
+}
+
+// static
+void* XComponent::operator new(size_t size, ComponentArena* arena) {
+  return ComponentArena::Allocate(size, arena);
+}
+
+// static
+void XComponent::operator delete(void* pointer) {
+  ComponentArena::Free(pointer);
+}
+
+// static
+void XComponent::operator delete(void* pointer, ComponentArena*) {
+  ComponentArena::Free(pointer);
+}
+
+ComponentId XComponent::GetId() const {
+  return id_;
+}
+
+ComponentHandle XComponent::GetHandle() const {
+  return ComponentHandle(id_);
+}
+
+// static
+XComponent* XComponent::Find(ComponentId id) {
+  Registry& registry = GetRegistry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  auto itr = registry.components.find(id);
+  return itr == registry.components.end() ? nullptr : itr->second;
+}
 
 void XComponent::SetParent(XContainer* parent) {
   parent_ = parent;
@@ -52,7 +100,7 @@ std::string XComponent::GetName(int indent) const {
   std::stringstream sstream;
   for (int i=0; i<indent; i++)
     sstream << "  ";
-  sstream << uuid_;
+  sstream << std::hex << std::setw(16) << std::setfill('0') << id_;
   return sstream.str();
 }
 
@@ -106,6 +154,19 @@ void XComponent::Repaint() {
     parent_->Repaint();
 }
 
+void XComponent::InvalidateLayout() {
+  if (parent_)
+    parent_->InvalidateLayout();
+}
+
+bool XComponent::HasFlatChildren() const {
+  return false;
+}
+
+bool XComponent::IsOpaque() const {
+  return false;
+}
+
 void XComponent::AddMouseMotionListener(
     std::shared_ptr<MouseMotionListener> listener) {
   motion_listeners_.push_back(listener);
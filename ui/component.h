@@ -1,23 +1,56 @@
 #pragma once
 
 #include <atomic>
+#include <cstdint>
 #include <memory>
 
 #include "event/mouse_listener.h"
 #include "event/mouse_motion_listener.h"
 #include "event/mouse_wheel_listener.h"
 #include "graphics.h"
+#include "small_vector.h"
 #include "window_interface.h"
 #include "layout/layout.h"
 
 namespace xpp::ui {
 
+class ComponentArena;
+class XComponent;
 class XContainer;
 
+// Handed out in creation order and never reused within a process.
+using ComponentId = uint64_t;
+
+// Names a component without owning it. Get() returns null once the
+// component has been destroyed.
+class ComponentHandle {
+ public:
+  explicit ComponentHandle(ComponentId id = 0) : id_(id) {}
+
+  ComponentId id() const { return id_; }
+  XComponent* Get() const;
+
+ private:
+  ComponentId id_;
+};
+
 class XComponent {
  public:
   XComponent();
-  virtual ~XComponent() = default;
+  virtual ~XComponent();
+
+  ComponentId GetId() const;
+  ComponentHandle GetHandle() const;
+
+  // The live component with |id|, or null.
+  static XComponent* Find(ComponentId id);
+
+  // Every component, whatever it derives from, is allocated through these,
+  // so that one made by ComponentArena::Make() is freed back to its arena.
+  static void* operator new(size_t size);
+  static void* operator new(size_t size, ComponentArena* arena);
+  static void operator delete(void* pointer);
+  static void operator delete(void* pointer, ComponentArena* arena);
 
   virtual void Paint(Graphics* g);
 
@@ -27,6 +60,16 @@ class XComponent {
   virtual const gfx::Rect& GetDimensions() const;
   virtual void SetParent(XContainer* parent);
   virtual void Repaint();
+  // Tells the window that children were added, removed or moved around, so
+  // positions it kept from the last layout are stale. Components whose
+  // layout depends on their own state call this before Repaint().
+  virtual void InvalidateLayout();
+  // Whether this is a container that the window's render list can paint the
+  // children of directly, see XContainer::PaintContents().
+  virtual bool HasFlatChildren() const;
+  // Whether Paint() covers every pixel of the component's bounds, so that
+  // whatever was painted underneath can be skipped.
+  virtual bool IsOpaque() const;
   virtual void SetDimensions(gfx::Rect size);
   virtual std::optional<gfx::Rect> GetPreferredSize();
   virtual std::optional<uint32_t> GetPreferredWidth();
@@ -47,14 +90,15 @@ class XComponent {
 
  private:
   XContainer* parent_ = nullptr;
-  std::string uuid_ = "";
+  const ComponentId id_;
   gfx::Rect size_ = {0, 0};
 
   std::atomic_flag is_in_size_method_ = false;
 
-  std::vector<std::shared_ptr<MouseMotionListener>> motion_listeners_;
-  std::vector<std::shared_ptr<MouseListener>> mouse_listeners_;
-  std::vector<std::shared_ptr<MouseWheelListener>> wheel_listeners_;
+  // Hardly any component has more than one of each.
+  SmallVector<std::shared_ptr<MouseMotionListener>, 1> motion_listeners_;
+  SmallVector<std::shared_ptr<MouseListener>, 1> mouse_listeners_;
+  SmallVector<std::shared_ptr<MouseWheelListener>, 1> wheel_listeners_;
 };
 
 }  // namespace xpp::ui
\ No newline at end of file
@@ -0,0 +1,89 @@
+#include "component_arena.h"
+
+#include <algorithm>
+#include <vector>
+
+namespace xpp::ui {
+
+namespace {
+
+struct alignas(std::max_align_t) BlockHeader {
+  // Null for components that came from the heap.
+  void* pool;
+};
+
+constexpr size_t kHeaderSize = sizeof(BlockHeader);
+
+size_t AlignUp(size_t size) {
+  constexpr size_t kAlign = alignof(std::max_align_t);
+  return (size + kAlign - 1) & ~(kAlign - 1);
+}
+
+}  // namespace
+
+struct ComponentArena::Pool {
+  std::vector<std::unique_ptr<std::byte[]>> chunks;
+  size_t chunk_size;
+  size_t reserved = 0;
+  // Free space left in chunks.back().
+  std::byte* next = nullptr;
+  size_t left = 0;
+  // Components still alive, and whether the arena itself is gone.
+  size_t live = 0;
+  bool orphaned = false;
+
+  void* Allocate(size_t size) {
+    if (size > left) {
+      const size_t chunk = std::max(size, chunk_size);
+      chunks.push_back(std::make_unique<std::byte[]>(chunk));
+      reserved += chunk;
+      next = chunks.back().get();
+      left = chunk;
+    }
+    void* block = next;
+    next += size;
+    left -= size;
+    live++;
+    return block;
+  }
+};
+
+ComponentArena::ComponentArena(size_t chunk_size)
+    : pool_(new Pool{.chunk_size = AlignUp(chunk_size)}) {}
+
+ComponentArena::~ComponentArena() {
+  if (!pool_->live) {
+    delete pool_;
+    return;
+  }
+  // The last component out frees the pool.
+  pool_->orphaned = true;
+}
+
+size_t ComponentArena::GetReservedBytes() const {
+  return pool_->reserved;
+}
+
+// static
+void* ComponentArena::Allocate(size_t size, ComponentArena* arena) {
+  size = kHeaderSize + AlignUp(size);
+  void* block = arena ? arena->pool_->Allocate(size) : ::operator new(size);
+  auto* header = new (block) BlockHeader{arena ? arena->pool_ : nullptr};
+  return reinterpret_cast<std::byte*>(header) + kHeaderSize;
+}
+
+// static
+void ComponentArena::Free(void* pointer) {
+  if (!pointer)
+    return;
+  auto* header = reinterpret_cast<BlockHeader*>(
+      reinterpret_cast<std::byte*>(pointer) - kHeaderSize);
+  if (!header->pool)
+    return ::operator delete(header);
+
+  auto* pool = static_cast<Pool*>(header->pool);
+  if (!--pool->live && pool->orphaned)
+    delete pool;
+}
+
+}  // namespace xpp::ui
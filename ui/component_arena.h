@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+namespace xpp::ui {
+
+class XComponent;
+
+// Bump-allocates components next to each other, for large subtrees that are
+// built and thrown away together, like a results list. Whatever Make()
+// returns is owned as usual and can go anywhere a make_unique'd component
+// can. Deleting one only runs its destructor; the memory comes back in one
+// piece once the arena and everything made from it are gone, in either
+// order.
+//
+// Single threaded, like the component tree itself.
+class ComponentArena {
+ public:
+  explicit ComponentArena(size_t chunk_size = 64 << 10);
+  ~ComponentArena();
+
+  ComponentArena(const ComponentArena&) = delete;
+  ComponentArena& operator=(const ComponentArena&) = delete;
+
+  template <typename T, typename... Args>
+  std::unique_ptr<T> Make(Args&&... args) {
+    static_assert(std::is_base_of_v<XComponent, T>);
+    static_assert(alignof(T) <= alignof(std::max_align_t),
+                  "blocks are only aligned for max_align_t");
+    return std::unique_ptr<T>(new (this) T(std::forward<Args>(args)...));
+  }
+
+  // Bytes taken from the heap so far.
+  size_t GetReservedBytes() const;
+
+  // Backs XComponent's operator new and delete. A null |arena| allocates
+  // from the heap.
+  static void* Allocate(size_t size, ComponentArena* arena);
+  static void Free(void* pointer);
+
+ private:
+  struct Pool;
+
+  Pool* pool_;
+};
+
+}  // namespace xpp::ui
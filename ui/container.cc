@@ -3,6 +3,7 @@
 #include "container.h"
 
 #include "../gfx/util.h"
+#include "canvas.h"
 #include "layout/fill_layout.h"
 
 #include <iostream>
@@ -22,10 +23,19 @@ XContainer::XContainer()
 
 void XContainer::AddComponent(std::unique_ptr<XComponent> component,
                               int32_t key) {
-  component->SetParent(this);
+  AppendComponent(std::move(component), key);
+}
+
+void XContainer::AppendComponent(std::unique_ptr<XComponent> component,
+                                 int32_t key) {
+  XComponent* child = component.get();
+  child->SetParent(this);
+  index_[child] = components_.size();
   auto packed = std::make_tuple<std::unique_ptr<XComponent>, int32_t>(
       std::move(component), std::move(key));
   components_.push_back(std::move(packed));
+  InvalidateLayout();
+  NotifyAdded(child);
 }
 
 void XContainer::AddComponent(std::unique_ptr<XComponent> component) {
@@ -34,31 +44,171 @@ void XContainer::AddComponent(std::unique_ptr<XComponent> component) {
 
 void XContainer::SetLayout(std::unique_ptr<Layout> layout) {
   layout_ = std::move(layout);
+  InvalidateLayout();
 }
 
 void XContainer::RemoveComponent(XComponent* to_remove) {
-  std::vector<std::tuple<std::unique_ptr<XComponent>, int32_t>> replacement;
-  for (auto& comp : components_) {
-    if (std::get<0>(comp)->GetName() == to_remove->GetName()) {
-      ContainerEvent event = {.parent = this,
-                              .child = std::move(std::get<0>(comp))};
-      for (const auto& listener : container_listeners_)
-        listener->ComponentRemoved(&event);
-    } else {
-      replacement.push_back(std::move(comp));
+  auto itr = index_.find(to_remove);
+  if (itr == index_.end())
+    return;
+  std::unique_ptr<XComponent> removed =
+      std::move(std::get<0>(components_[itr->second]));
+  index_.erase(itr);
+  empty_slots_++;
+
+  InvalidateLayout();
+  NotifyRemoved(std::move(removed));
+}
+
+void XContainer::RemoveAll() {
+  // Emptied first, so listeners see the container as it will be.
+  std::vector<ComponentStorageType> removed = std::move(components_);
+  components_.clear();
+  index_.clear();
+  empty_slots_ = 0;
+  InvalidateLayout();
+  for (auto& comp : removed) {
+    if (std::get<0>(comp))
+      NotifyRemoved(std::move(std::get<0>(comp)));
+  }
+}
+
+void XContainer::Compact() const {
+  if (!empty_slots_)
+    return;
+  size_t kept = 0;
+  for (size_t i = 0; i < components_.size(); i++) {
+    const XComponent* child = std::get<0>(components_[i]).get();
+    if (!child)
+      continue;
+    if (kept != i) {
+      components_[kept] = std::move(components_[i]);
+      index_[child] = kept;
     }
+    kept++;
   }
-  components_ = std::move(replacement);
+  components_.erase(components_.begin() + kept, components_.end());
+  empty_slots_ = 0;
 }
 
-void XContainer::RemoveAll() {
-  for (auto& comp : components_) {
-    ContainerEvent event = {.parent = this,
-                            .child = std::move(std::get<0>(comp))};
-    for (const auto& listener : container_listeners_)
-      listener->ComponentRemoved(&event);
+void XContainer::ReplaceComponents(
+    size_t position,
+    size_t count,
+    std::vector<std::unique_ptr<XComponent>> components,
+    int32_t key) {
+  Compact();
+  position = std::min(position, components_.size());
+  count = std::min(count, components_.size() - position);
+  if (!count && components.empty())
+    return;
+
+  // Held here so that the listeners only see the finished list, and the
+  // container repaints once, the same as inside an UpdateScope.
+  BeginUpdate();
+  InvalidateLayout();
+  for (size_t i = position; i < position + count; i++) {
+    std::unique_ptr<XComponent>& slot = std::get<0>(components_[i]);
+    index_.erase(slot.get());
+    NotifyRemoved(std::move(slot));
   }
-  components_.clear();
+
+  // Reuse the removed slots, then shift the tail once for the difference.
+  const size_t reused = std::min(count, components.size());
+  for (size_t i = 0; i < reused; i++)
+    components_[position + i] = {std::move(components[i]), key};
+  if (count > reused) {
+    components_.erase(components_.begin() + position + reused,
+                      components_.begin() + position + count);
+  } else if (components.size() > reused) {
+    std::vector<ComponentStorageType> extra;
+    extra.reserve(components.size() - reused);
+    for (size_t i = reused; i < components.size(); i++)
+      extra.emplace_back(std::move(components[i]), key);
+    components_.insert(components_.begin() + position + reused,
+                       std::make_move_iterator(extra.begin()),
+                       std::make_move_iterator(extra.end()));
+  }
+
+  const size_t reindex_end = count == components.size()
+                                 ? position + count
+                                 : components_.size();
+  for (size_t i = position; i < reindex_end; i++)
+    index_[std::get<0>(components_[i]).get()] = i;
+  for (size_t i = position; i < position + components.size(); i++) {
+    XComponent* child = std::get<0>(components_[i]).get();
+    child->SetParent(this);
+    NotifyAdded(child);
+  }
+
+  EndUpdate();
+}
+
+void XContainer::InsertComponents(
+    size_t position,
+    std::vector<std::unique_ptr<XComponent>> components,
+    int32_t key) {
+  ReplaceComponents(position, 0, std::move(components), key);
+}
+
+void XContainer::RemoveComponents(size_t position, size_t count) {
+  ReplaceComponents(position, count, {});
+}
+
+void XContainer::BeginUpdate() {
+  update_depth_++;
+}
+
+void XContainer::EndUpdate() {
+  CHECK(update_depth_ > 0);
+  if (--update_depth_)
+    return;
+  const bool changed = children_changed_;
+  DeliverPending();
+  if (changed)
+    Repaint();
+}
+
+XContainer::UpdateScope::UpdateScope(XContainer* container)
+    : container_(container) {
+  container_->BeginUpdate();
+}
+
+XContainer::UpdateScope::~UpdateScope() {
+  container_->EndUpdate();
+}
+
+void XContainer::NotifyAdded(XComponent* child) {
+  if (update_depth_) {
+    children_changed_ = true;
+    pending_.added.push_back({.parent = this, .child = child});
+    return;
+  }
+  ContainerEvent event = {.parent = this, .child = child};
+  for (const auto& listener : container_listeners_)
+    listener->ComponentAdded(&event);
+}
+
+void XContainer::NotifyRemoved(std::unique_ptr<XComponent> child) {
+  if (update_depth_) {
+    children_changed_ = true;
+    pending_.removed.push_back({.parent = this, .child = std::move(child)});
+    return;
+  }
+  ContainerEvent event = {.parent = this, .child = std::move(child)};
+  for (const auto& listener : container_listeners_)
+    listener->ComponentRemoved(&event);
+}
+
+void XContainer::DeliverPending() {
+  children_changed_ = false;
+  if (pending_.added.empty() && pending_.removed.empty())
+    return;
+  // Swapped out first, so listeners may start another update.
+  ContainerBatchEvent batch = {.parent = this};
+  std::swap(batch.added, pending_.added);
+  std::swap(batch.removed, pending_.removed);
+  for (const auto& listener : container_listeners_)
+    listener->ComponentsChanged(&batch);
 }
 
 void XContainer::AddComponentListener(
@@ -68,6 +218,7 @@ void XContainer::AddComponentListener(
 
 const std::vector<XContainer::ComponentStorageType>&
 XContainer::GetComponents() const {
+  Compact();
   return components_;
 }
 
@@ -96,21 +247,57 @@ std::string XContainer::GetName(int indent) const {
   return sstream.str();
 }
 
-void XContainer::Paint(Graphics* g) {
+Layout::Positions XContainer::LayoutChildren(gfx::Rect size) {
+  Compact();
+  return layout_->DoLayout(components_, size);
+}
+
+void XContainer::PaintContents(Graphics* g) {
   XComponent::Paint(g);
-  auto positions = layout_->DoLayout(components_, g->GetDimensions());
+}
+
+bool XContainer::HasFlatChildren() const {
+  return true;
+}
+
+gfx::Rect XContainer::GetContentSize(gfx::Rect size) {
+  return size;
+}
+
+gfx::Coord XContainer::GetContentOffset() {
+  return {0, 0};
+}
+
+void XContainer::Paint(Graphics* g) {
+  const gfx::Rect size = g->GetDimensions();
+  const gfx::Rect content = GetContentSize(size);
+  const gfx::Coord offset = GetContentOffset();
+
+  // Scrolled content is painted whole offscreen and the visible part
+  // copied in.
+  std::unique_ptr<XCanvas> canvas;
+  Graphics* target = g;
+  if (!(content == size) || !(offset == gfx::Coord{0, 0})) {
+    canvas = g->CreateCanvas(content);
+    target = canvas->GetGraphics();
+  }
+
+  PaintContents(target);
+  auto positions = LayoutChildren(content);
   std::sort(positions.begin(), positions.end(), ZIndexSort);
   for (auto position : positions) {
-    Graphics sub = g->SubGraphics(position.at, position.size);
+    Graphics sub = target->SubGraphics(position.at, position.size);
     position.component->Paint(&sub);
   }
+  if (canvas)
+    canvas->MapOnTo(g, offset);
 }
 
 void XContainer::MouseEntered(MouseMotionEvent* event) {
   XComponent::MouseEntered(event);
   if (!event->active)
     return;
-  for (auto position : layout_->DoLayout(components_, GetDimensions())) {
+  for (auto position : LayoutChildren(GetDimensions())) {
     auto inner = InnerPosition({position.at, position.size}, event->location);
     if (inner.has_value()) {
       MouseMotionEvent copy = {inner.value(), inner.value(),
@@ -126,7 +313,7 @@ void XContainer::MouseExited(MouseMotionEvent* event) {
   XComponent::MouseExited(event);
   if (!event->active)
     return;
-  for (auto position : layout_->DoLayout(components_, GetDimensions())) {
+  for (auto position : LayoutChildren(GetDimensions())) {
     auto inner = InnerPosition({position.at, position.size}, event->location);
     if (inner.has_value()) {
       MouseMotionEvent copy = {inner.value(), inner.value(),
@@ -143,7 +330,7 @@ void XContainer::MouseMoved(MouseMotionEvent* event) {
   if (!event->active)
     return;
   bool moved = false;
-  for (auto position : layout_->DoLayout(components_, GetDimensions())) {
+  for (auto position : LayoutChildren(GetDimensions())) {
     auto at = InnerPosition({position.at, position.size}, event->location);
     auto prev =
         InnerPosition({position.at, position.size}, event->previous_location);
@@ -171,7 +358,7 @@ void XContainer::MouseDragged(MouseMotionEvent* event) {
   if (!event->active)
     return;
   bool moved = false;
-  for (auto position : layout_->DoLayout(components_, GetDimensions())) {
+  for (auto position : LayoutChildren(GetDimensions())) {
     auto at = InnerPosition({position.at, position.size}, event->location);
     auto prev =
         InnerPosition({position.at, position.size}, event->previous_location);
@@ -198,7 +385,7 @@ void XContainer::MousePressed(MouseEvent* event) {
   XComponent::MousePressed(event);
   if (!event->active)
     return;
-  for (auto position : layout_->DoLayout(components_, GetDimensions())) {
+  for (auto position : LayoutChildren(GetDimensions())) {
     auto inner = InnerPosition({position.at, position.size}, event->location);
     if (inner.has_value()) {
       MouseEvent copy = {inner.value(), event->mouse_button,
@@ -214,7 +401,7 @@ void XContainer::MouseClicked(MouseEvent* event) {
   XComponent::MouseClicked(event);
   if (!event->active)
     return;
-  for (auto position : layout_->DoLayout(components_, GetDimensions())) {
+  for (auto position : LayoutChildren(GetDimensions())) {
     auto inner = InnerPosition({position.at, position.size}, event->location);
     if (inner.has_value()) {
       MouseEvent copy = {inner.value(), event->mouse_button,
@@ -230,7 +417,7 @@ void XContainer::MouseReleased(MouseEvent* event) {
   XComponent::MouseReleased(event);
   if (!event->active)
     return;
-  for (auto position : layout_->DoLayout(components_, GetDimensions())) {
+  for (auto position : LayoutChildren(GetDimensions())) {
     auto inner = InnerPosition({position.at, position.size}, event->location);
     if (inner.has_value()) {
       MouseEvent copy = {inner.value(), event->mouse_button,
@@ -246,7 +433,7 @@ void XContainer::WheelScrolled(MouseWheelEvent* event) {
   XComponent::WheelScrolled(event);
   if (!event->active)
     return;
-  for (auto position : layout_->DoLayout(components_, GetDimensions())) {
+  for (auto position : LayoutChildren(GetDimensions())) {
     auto inner = InnerPosition({position.at, position.size}, event->location);
     if (inner.has_value()) {
       MouseWheelEvent copy = {inner.value(), event->vector, position.component};
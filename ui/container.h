@@ -1,5 +1,6 @@
 #pragma once
 
+#include <unordered_map>
 #include <vector>
 
 #include "component.h"
@@ -15,8 +16,42 @@ class XContainer : public XComponent {
 
   virtual void AddComponent(std::unique_ptr<XComponent> component, int32_t key);
   virtual void AddComponent(std::unique_ptr<XComponent> component);
-  virtual void RemoveComponent(XComponent*);
+  // O(1): finds |component| through an index and leaves its slot empty.
+  virtual void RemoveComponent(XComponent* component);
   virtual void RemoveAll();
+
+  // Replaces |count| children from |position| in GetComponents() with
+  // |components|, moving the rest of the list once. Listeners hear about it
+  // in a single ComponentsChanged() call.
+  virtual void ReplaceComponents(
+      size_t position,
+      size_t count,
+      std::vector<std::unique_ptr<XComponent>> components,
+      int32_t key = 0);
+  void InsertComponents(size_t position,
+                        std::vector<std::unique_ptr<XComponent>> components,
+                        int32_t key = 0);
+  void RemoveComponents(size_t position, size_t count);
+
+  // Between these, listener notifications are held back and delivered as one
+  // batch by the outermost EndUpdate(), which then repaints once if the
+  // children changed. Layout runs at paint time, so an update costs a single
+  // layout however many children it touches. Prefer UpdateScope.
+  virtual void BeginUpdate();
+  virtual void EndUpdate();
+
+  class UpdateScope {
+   public:
+    explicit UpdateScope(XContainer* container);
+    ~UpdateScope();
+
+    UpdateScope(const UpdateScope&) = delete;
+    UpdateScope& operator=(const UpdateScope&) = delete;
+
+   private:
+    XContainer* container_;
+  };
+
   virtual void SetLayout(std::unique_ptr<Layout>);
   virtual void AddComponentListener(std::shared_ptr<ContainerListener>);
   virtual std::string GetTypeName() const;
@@ -24,9 +59,26 @@ class XContainer : public XComponent {
   const std::vector<ComponentStorageType>& GetComponents() const;
 
 
+  // Where the layout puts the children inside |size|.
+  Layout::Positions LayoutChildren(gfx::Rect size);
+
+  // What the container draws under its children; Paint() is this followed
+  // by the children. Subclasses draw themselves here, so the window can
+  // paint their children straight from its render list.
+  virtual void PaintContents(Graphics* g);
+
+  // The area the children are laid out in when the container is |size|,
+  // and where in that area the container shows from. A scrolling container
+  // lays its children out larger than itself and shifts them.
+  virtual gfx::Rect GetContentSize(gfx::Rect size);
+  virtual gfx::Coord GetContentOffset();
+
   // XComponent overrides
   std::string GetName(int indent = 0) const override;
-  virtual void Paint(Graphics* g) override;
+  // Final: the render list paints flat containers without calling it, so
+  // anything a subclass drew here would be lost. Draw in PaintContents().
+  void Paint(Graphics* g) final;
+  bool HasFlatChildren() const override;
 
   // XComponent listener overrides
   virtual void MouseEntered(MouseMotionEvent*) override;
@@ -39,10 +91,32 @@ class XContainer : public XComponent {
   virtual void WheelScrolled(MouseWheelEvent*) override;
 
  protected:
-  std::vector<ComponentStorageType> components_;
+  // Appends without going through the AddComponent() overrides. Subclasses
+  // building their own children use this so that |index_| stays right.
+  void AppendComponent(std::unique_ptr<XComponent> component, int32_t key);
+
+  // Tell the listeners now, or add to the pending batch inside an update.
+  void NotifyAdded(XComponent* child);
+  void NotifyRemoved(std::unique_ptr<XComponent> child);
+  // Hands the pending batch, if any, to the listeners.
+  void DeliverPending();
+
+  // Squeezes the empty slots RemoveComponent() left out of |components_| in
+  // one pass. Everything that reads the list calls this first, so removing
+  // many children one by one stays linear.
+  void Compact() const;
+
+  mutable std::vector<ComponentStorageType> components_;
+  // Where each child sits in |components_|.
+  mutable std::unordered_map<const XComponent*, size_t> index_;
+  mutable size_t empty_slots_ = 0;
   std::unique_ptr<Layout> layout_;
 
-  std::vector<std::shared_ptr<ContainerListener>> container_listeners_;
+  SmallVector<std::shared_ptr<ContainerListener>, 1> container_listeners_;
+
+  uint32_t update_depth_ = 0;
+  bool children_changed_ = false;
+  ContainerBatchEvent pending_ = {.parent = this};
 };
 
 }  // namespace xpp::ui
\ No newline at end of file
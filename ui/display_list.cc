@@ -0,0 +1,50 @@
+#include "display_list.h"
+
+#include "graphics.h"
+
+namespace xpp::ui {
+
+namespace {
+
+template <typename... Fns>
+struct Visitor : Fns... {
+  using Fns::operator()...;
+};
+
+template <typename... Fns>
+Visitor(Fns...) -> Visitor<Fns...>;
+
+}  // namespace
+
+const std::vector<DisplayList::Op>& DisplayList::GetOps() const {
+  return ops_;
+}
+
+void DisplayList::Replay(Graphics* g) const {
+  for (const auto& op : ops_) {
+    std::visit(
+        Visitor{
+            [g](const ops::SetColor& op) { g->SetColor(op.color); },
+            [g](const ops::SetFont& op) { g->SetFont(op.font); },
+            [g](const ops::FillRect& op) { g->FillRect(op.at, op.size); },
+            [g](const ops::DrawRect& op) { g->DrawRect(op.at, op.size); },
+            [g](const ops::FillRoundedRect& op) {
+              g->FillRoundedRect(op.at, op.size, op.radius);
+            },
+            [g](const ops::DrawRoundedRect& op) {
+              g->DrawRoundedRect(op.at, op.size, op.radius);
+            },
+            [g](const ops::FillGradient& op) {
+              g->FillGradient(op.at, op.size, op.gradient);
+            },
+            [g](const ops::DrawText& op) { g->DrawText(op.at, op.message); },
+            [g](const ops::Layer& op) {
+              Graphics dest = g->SubGraphics(op.dest, op.dest_size);
+              dest.DrawRecording(op.list, op.layer_size, op.source);
+            },
+        },
+        op);
+  }
+}
+
+}  // namespace xpp::ui
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <variant>
+#include <vector>
+
+#include "../gfx/color.h"
+#include "../gfx/coord.h"
+#include "../gfx/rect.h"
+#include "font.h"
+#include "gradient.h"
+
+namespace xpp::ui {
+
+class DisplayList;
+class Graphics;
+
+namespace ops {
+
+struct SetColor {
+  gfx::Color color;
+};
+
+struct SetFont {
+  gfx::Font font;
+};
+
+struct FillRect {
+  gfx::Coord at;
+  gfx::Rect size;
+};
+
+struct DrawRect {
+  gfx::Coord at;
+  gfx::Rect size;
+};
+
+struct FillRoundedRect {
+  gfx::Coord at;
+  gfx::Rect size;
+  uint32_t radius;
+};
+
+struct DrawRoundedRect {
+  gfx::Coord at;
+  gfx::Rect size;
+  uint32_t radius;
+};
+
+struct FillGradient {
+  gfx::Coord at;
+  gfx::Rect size;
+  Gradient gradient;
+};
+
+struct DrawText {
+  gfx::Coord at;
+  std::string message;
+};
+
+// An offscreen canvas of |layer_size|, copied from |source| onto the area
+// |dest_size| at |dest|.
+struct Layer {
+  std::shared_ptr<const DisplayList> list;
+  gfx::Rect layer_size;
+  gfx::Coord source;
+  gfx::Coord dest;
+  gfx::Rect dest_size;
+};
+
+}  // namespace ops
+
+// A recording of the calls made against a Graphics object, with every
+// coordinate already translated into the recording root's space. Once handed
+// off, a list is never modified again, so it can be replayed from any thread.
+class DisplayList {
+ public:
+  using Op = std::variant<ops::SetColor,
+                          ops::SetFont,
+                          ops::FillRect,
+                          ops::DrawRect,
+                          ops::FillRoundedRect,
+                          ops::DrawRoundedRect,
+                          ops::FillGradient,
+                          ops::DrawText,
+                          ops::Layer>;
+
+  template <typename T>
+  void Append(T&& op) {
+    ops_.emplace_back(std::forward<T>(op));
+  }
+
+  const std::vector<Op>& GetOps() const;
+
+  // Re-issues every recorded op against |g|, which must be unoffset.
+  void Replay(Graphics* g) const;
+
+ private:
+  std::vector<Op> ops_;
+};
+
+}  // namespace xpp::ui
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <vector>
+
 #include "base/proxy_ptr.h"
 
 namespace xpp::ui {
@@ -11,10 +13,28 @@ struct ContainerEvent {
   base::proxy_ptr<XComponent> child;
 };
 
+// Everything done to a container's children during one update. Removed
+// children stay alive until the listeners have seen the batch.
+struct ContainerBatchEvent {
+  XComponent* parent;
+  std::vector<ContainerEvent> added;
+  std::vector<ContainerEvent> removed;
+};
+
 class ContainerListener {
  public:
   virtual void ComponentRemoved(ContainerEvent*) = 0;
   virtual void ComponentAdded(ContainerEvent*) = 0;
+
+  // Sent once at the end of an update instead of the calls above. By
+  // default, replays the additions and then the removals, so a child that
+  // was added and removed again within the batch is seen in that order.
+  virtual void ComponentsChanged(ContainerBatchEvent* batch) {
+    for (ContainerEvent& event : batch->added)
+      ComponentAdded(&event);
+    for (ContainerEvent& event : batch->removed)
+      ComponentRemoved(&event);
+  }
 };
 
 }  // namespace xpp::ui
\ No newline at end of file
@@ -2,6 +2,7 @@
 
 #include <X11/Xft/Xft.h>
 #include <X11/Xlib.h>
+#include <memory>
 #include <string>
 
 #include "../xlib/xgraphics.h"
@@ -9,6 +10,8 @@
 namespace xpp::ui {
 class LookAndFeel;
 class Graphics;
+class SoftwareRasterizer;
+class TextEngine;
 }  // namespace xpp::ui
 
 namespace xpp::gfx {
@@ -26,23 +29,25 @@ class Font {
     }
   }
 
-  void DeleteEarly(xlib::XGraphics* gfx) {
-    // Not responsible for deleting the xft context!
-    if (xft_font_)
-      gfx->XftFontClose(xft_font_);
+  // Whether both refer to the same open font.
+  bool operator==(const Font& other) const {
+    return mode_ == other.mode_ && xft_font_ == other.xft_font_ &&
+           xfont_ == other.xfont_;
   }
 
  private:
   friend class xpp::ui::LookAndFeel;
   friend class xpp::ui::Graphics;
+  friend class xpp::ui::SoftwareRasterizer;
+  friend class xpp::ui::TextEngine;
 
   std::string font_name_;
-  uint16_t size_;
+  uint16_t size_ = 0;
 
   TextRenderingMode mode_ = TextRenderingMode::kNone;
 
-  XftDraw* xft_ctx_ = nullptr;
-  XftFont* xft_font_ = nullptr;
+  // A handle from the display's XFontCache, which closes the font.
+  std::shared_ptr<XftFont> xft_font_;
 
   XFontStruct* xfont_ = nullptr;
 };
@@ -0,0 +1,71 @@
+#include "frame_arena.h"
+
+namespace xpp::ui {
+
+namespace {
+
+thread_local FrameArena* current_arena = nullptr;
+thread_local std::pmr::memory_resource* current_resource = nullptr;
+
+}  // namespace
+
+FrameArena::FrameArena(size_t initial_size)
+    : capacity_(initial_size),
+      buffer_(std::make_unique<std::byte[]>(initial_size)) {
+  resource_.emplace(buffer_.get(), capacity_, &overflow_);
+}
+
+// static
+std::pmr::memory_resource* FrameArena::Current() {
+  return current_resource ? current_resource
+                          : std::pmr::get_default_resource();
+}
+
+FrameArena::Scope::Scope(FrameArena* arena)
+    : arena_(arena), previous_(current_arena) {
+  arena_->depth_++;
+  current_arena = arena_;
+  current_resource = &*arena_->resource_;
+}
+
+FrameArena::Scope::~Scope() {
+  if (!--arena_->depth_)
+    arena_->Release();
+  current_arena = previous_;
+  current_resource = previous_ ? &*previous_->resource_ : nullptr;
+}
+
+size_t FrameArena::GetCapacity() const {
+  return capacity_;
+}
+
+void FrameArena::Release() {
+  resource_->release();
+  if (!overflow_.allocated)
+    return;
+
+  // Make room for everything this frame needed, with some to spare.
+  capacity_ = (capacity_ + overflow_.allocated) * 2;
+  overflow_.allocated = 0;
+  resource_.reset();
+  buffer_ = std::make_unique<std::byte[]>(capacity_);
+  resource_.emplace(buffer_.get(), capacity_, &overflow_);
+}
+
+void* FrameArena::Overflow::do_allocate(size_t bytes, size_t alignment) {
+  allocated += bytes;
+  return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+}
+
+void FrameArena::Overflow::do_deallocate(void* p,
+                                         size_t bytes,
+                                         size_t alignment) {
+  std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+}
+
+bool FrameArena::Overflow::do_is_equal(
+    const memory_resource& other) const noexcept {
+  return this == &other;
+}
+
+}  // namespace xpp::ui
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include <optional>
+
+namespace xpp::ui {
+
+// Scratch memory for one frame of event dispatch and painting: layout
+// results and whatever else only lives until the frame is done. Everything
+// is released at once when the frame ends. A frame that needed more than
+// the arena had grows it for the next one, so once a window has settled
+// its frames don't touch the heap at all.
+class FrameArena {
+ public:
+  explicit FrameArena(size_t initial_size = 16 << 10);
+
+  // The arena of the frame this thread is in, or the default resource when
+  // it isn't in one.
+  static std::pmr::memory_resource* Current();
+
+  // Makes |arena| current on this thread for as long as it lives. Scopes
+  // can nest, e.g. a repaint from inside an event handler; the arena is
+  // released when the outermost one closes.
+  class Scope {
+   public:
+    explicit Scope(FrameArena* arena);
+    ~Scope();
+
+    Scope(const Scope&) = delete;
+    Scope& operator=(const Scope&) = delete;
+
+   private:
+    FrameArena* arena_;
+    FrameArena* previous_;
+  };
+
+  // How much the arena holds before it has to go to the heap.
+  size_t GetCapacity() const;
+
+ private:
+  // Hands overflow to the heap, counting it.
+  class Overflow : public std::pmr::memory_resource {
+   public:
+    size_t allocated = 0;
+
+   private:
+    void* do_allocate(size_t bytes, size_t alignment) override;
+    void do_deallocate(void* p, size_t bytes, size_t alignment) override;
+    bool do_is_equal(const memory_resource& other) const noexcept override;
+  };
+
+  void Release();
+
+  size_t capacity_;
+  std::unique_ptr<std::byte[]> buffer_;
+  Overflow overflow_;
+  std::optional<std::pmr::monotonic_buffer_resource> resource_;
+  int depth_ = 0;
+};
+
+}  // namespace xpp::ui
@@ -0,0 +1,43 @@
+#include "frame_pipeline.h"
+
+namespace xpp::ui {
+
+FramePipeline::FramePipeline(Rasterizer rasterizer, size_t depth)
+    : rasterizer_(std::move(rasterizer)),
+      depth_(std::max<size_t>(depth, 1)),
+      thread_(&FramePipeline::Run, this) {}
+
+FramePipeline::~FramePipeline() {
+  {
+    std::lock_guard<std::mutex> hold(lock_);
+    stopping_ = true;
+  }
+  changed_.notify_all();
+  thread_.join();
+}
+
+void FramePipeline::Submit(Frame frame) {
+  std::unique_lock<std::mutex> hold(lock_);
+  changed_.wait(hold, [this] { return frames_.size() < depth_; });
+  frames_.push_back(std::move(frame));
+  hold.unlock();
+  changed_.notify_all();
+}
+
+void FramePipeline::Run() {
+  while (true) {
+    std::unique_lock<std::mutex> hold(lock_);
+    changed_.wait(hold, [this] { return stopping_ || !frames_.empty(); });
+    if (frames_.empty())
+      return;
+    Frame frame = std::move(frames_.front());
+    frames_.pop_front();
+    hold.unlock();
+
+    // Wake a painter that was blocked on a full queue.
+    changed_.notify_all();
+    rasterizer_(frame);
+  }
+}
+
+}  // namespace xpp::ui
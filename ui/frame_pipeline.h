@@ -0,0 +1,48 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include "../gfx/rect.h"
+#include "display_list.h"
+
+namespace xpp::ui {
+
+// Hands recorded frames from the thread that paints the component tree to a
+// dedicated render thread. At most |depth| frames may be waiting at once; any
+// further Submit() blocks until the render thread catches up.
+class FramePipeline {
+ public:
+  struct Frame {
+    std::shared_ptr<const DisplayList> list;
+    gfx::Rect size;
+  };
+
+  using Rasterizer = std::function<void(const Frame&)>;
+
+  FramePipeline(Rasterizer rasterizer, size_t depth = 2);
+
+  // Rasterizes anything still queued before joining the render thread.
+  ~FramePipeline();
+
+  void Submit(Frame frame);
+
+ private:
+  void Run();
+
+  Rasterizer rasterizer_;
+  size_t depth_;
+
+  std::mutex lock_;
+  std::condition_variable changed_;
+  std::deque<Frame> frames_;
+  bool stopping_ = false;
+
+  std::thread thread_;
+};
+
+}  // namespace xpp::ui
@@ -0,0 +1,89 @@
+#include "gradient.h"
+
+#include <cmath>
+
+#include "../gfx/color_batch.h"
+
+namespace xpp::ui {
+
+void ForEachGradientBand(
+    const Gradient& gradient,
+    gfx::Rect size,
+    const std::function<void(gfx::Color, const std::vector<GradientSpan>&)>&
+        paint) {
+  if (!size.width || !size.height)
+    return;
+
+  const double cx = size.width / 2.0;
+  const double cy = size.height / 2.0;
+  size_t steps = 0;
+  switch (gradient.shape) {
+    case GradientShape::kHorizontal:
+      steps = size.width;
+      break;
+    case GradientShape::kVertical:
+      steps = size.height;
+      break;
+    case GradientShape::kRadial:
+      steps = std::max<size_t>(std::ceil(std::hypot(cx, cy)), 1);
+      break;
+  }
+
+  std::vector<gfx::Color> ramp(steps);
+  gfx::InterpolateHSL(gradient.from, gradient.to, ramp.data(), steps);
+
+  // Neighbouring steps that came out the same color share a band.
+  std::vector<uint32_t> band_of(steps);
+  std::vector<gfx::Color> colors;
+  for (size_t i = 0; i < steps; i++) {
+    if (colors.empty() || !(colors.back() == ramp[i]))
+      colors.push_back(ramp[i]);
+    band_of[i] = colors.size() - 1;
+  }
+
+  std::vector<std::vector<GradientSpan>> bands(colors.size());
+  switch (gradient.shape) {
+    case GradientShape::kHorizontal: {
+      for (uint32_t x = 0; x < size.width; x++) {
+        auto& spans = bands[band_of[x]];
+        if (spans.empty())
+          spans.push_back({x, 0, 0, size.height});
+        spans.back().width++;
+      }
+      break;
+    }
+    case GradientShape::kVertical: {
+      for (uint32_t y = 0; y < size.height; y++) {
+        auto& spans = bands[band_of[y]];
+        if (spans.empty())
+          spans.push_back({0, y, size.width, 0});
+        spans.back().height++;
+      }
+      break;
+    }
+    case GradientShape::kRadial: {
+      auto band_at = [&](uint32_t x, uint32_t y) {
+        double distance = std::hypot(x + 0.5 - cx, y + 0.5 - cy);
+        return band_of[std::min<size_t>(distance, steps - 1)];
+      };
+      for (uint32_t y = 0; y < size.height; y++) {
+        uint32_t start = 0;
+        uint32_t band = band_at(0, y);
+        for (uint32_t x = 1; x <= size.width; x++) {
+          uint32_t next = x < size.width ? band_at(x, y) : band + 1;
+          if (next == band)
+            continue;
+          bands[band].push_back({start, y, x - start, 1});
+          start = x;
+          band = next;
+        }
+      }
+      break;
+    }
+  }
+
+  for (size_t band = 0; band < bands.size(); band++)
+    paint(colors[band], bands[band]);
+}
+
+}  // namespace xpp::ui
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <functional>
+#include <vector>
+
+#include "../gfx/color.h"
+#include "../gfx/rect.h"
+
+namespace xpp::ui {
+
+enum class GradientShape {
+  kHorizontal,  // |from| at the left edge, |to| at the right.
+  kVertical,    // |from| along the top, |to| along the bottom.
+  kRadial,      // |from| in the center, |to| out in the corners.
+};
+
+struct Gradient {
+  gfx::Color from;
+  gfx::Color to;
+  GradientShape shape;
+};
+
+// A rectangle relative to the top left corner of the gradient.
+struct GradientSpan {
+  int64_t x;
+  int64_t y;
+  uint32_t width;
+  uint32_t height;
+};
+
+// Cuts a gradient covering |size| into bands of a single color and calls
+// |paint| once per band with every span it covers. Linear bands are a single
+// span; radial ones are a run on each row the ring crosses.
+void ForEachGradientBand(
+    const Gradient& gradient,
+    gfx::Rect size,
+    const std::function<void(gfx::Color, const std::vector<GradientSpan>&)>&
+        paint);
+
+}  // namespace xpp::ui
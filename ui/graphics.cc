@@ -1,153 +1,254 @@
 #include "graphics.h"
 
+#include <utility>
+#include <vector>
+
 #include "../xlib/xpixmap.h"
 #include "canvas.h"
+#include "display_list.h"
+#include "frame_arena.h"
 
 namespace xpp::ui {
 
-Graphics::Graphics(std::shared_ptr<xlib::XGraphics> g,
-                   std::shared_ptr<xlib::XColorMap> colormap,
-                   std::shared_ptr<LookAndFeel> laf,
-                   std::shared_ptr<xlib::XWindow> window,
-                   uint32_t depth,
-                   gfx::Rect size)
-    : graphics_(std::move(g)),
-      colormap_(std::move(colormap)),
-      laf_(std::move(laf)),
-      window_(window),
-      depth_(depth),
-      size_(size),
-      offset_({0, 0}) {
-  fonts_ = std::make_shared<LookAndFeel::FontCache>(graphics_);
-  SetFont(
-      laf_->AllocateFont(graphics_, "Fantasque Sans Mono", 10, fonts_.get()));
-}
-
-Graphics::Graphics(std::shared_ptr<xlib::XGraphics> g,
-                   std::shared_ptr<xlib::XColorMap> colormap,
-                   std::shared_ptr<LookAndFeel> laf,
-                   std::shared_ptr<xlib::XWindow> window,
-                   uint32_t depth,
+Graphics::Graphics(RenderContext* context,
                    gfx::Rect size,
-                   gfx::Coord offset,
-                   std::shared_ptr<LookAndFeel::FontCache> fonts)
-    : graphics_(std::move(g)),
-      colormap_(std::move(colormap)),
-      laf_(std::move(laf)),
-      window_(window),
-      fonts_(fonts),
-      depth_(depth),
+                   gfx::Coord offset)
+    : context_(context),
+      graphics_(context->graphics.get()),
+      laf_(context->laf.get()),
       size_(size),
-      offset_(offset) {
-  SetFont(
-      laf_->AllocateFont(graphics_, "Fantasque Sans Mono", 10, fonts_.get()));
-}
+      offset_(offset),
+      font_(context->default_font) {}
 
 void Graphics::SetColor(gfx::Color color) {
   color_ = color;
-  graphics_->XSetForeground(laf_->GetXColor(colormap_, color).pixel);
+  if (recording_)
+    return recording_->Append(ops::SetColor{color});
+  graphics_->XSetForeground(
+      laf_->GetPixel(context_->colormap, color, context_->pixels.get()));
 }
 
-void Graphics::SetColor(std::string color) {
+void Graphics::SetColor(ThemeKey key) {
+  color_ = laf_->GetColor(key);
+  if (recording_)
+    return recording_->Append(ops::SetColor{color_});
+  graphics_->XSetForeground(
+      laf_->GetPixel(context_->colormap, key, context_->pixels.get()));
+}
+
+void Graphics::SetColor(std::string_view color) {
   SetColor(laf_->GetColorByName(color));
 }
 
 void Graphics::SetFont(gfx::Font font) {
   font_ = font;
+  if (recording_)
+    recording_->Append(ops::SetFont{font});
 }
 
-void Graphics::SetFont(std::string fontname) {
-  font_ = laf_->GetFont(graphics_, fontname, font_, fonts_.get());
+void Graphics::SetFont(std::string_view fontname) {
+  SetFont(laf_->GetFont(graphics_, fontname, font_, context_->fonts.get()));
 }
 
 void Graphics::SetFontSize(uint16_t fontsize) {
-  font_ = laf_->GetFont(graphics_, fontsize, font_, fonts_.get());
+  SetFont(laf_->GetFont(graphics_, fontsize, font_, context_->fonts.get()));
 }
 
 gfx::Rect Graphics::GetDimensions() const {
   return size_;
 }
 
+const gfx::Font& Graphics::GetFont() const {
+  return font_;
+}
+
 uint32_t Graphics::GetFontHeight() const {
   return font_.Height();
 }
 
+gfx::Rect Graphics::MeasureText(std::string_view message) const {
+  return laf_->GetTextEngine()->Measure(graphics_, font_, message);
+}
+
+void Graphics::MeasurePrefixes(std::string_view message,
+                               std::vector<uint32_t>* widths) const {
+  laf_->GetTextEngine()->MeasurePrefixes(graphics_, font_, message, widths);
+}
+
 std::unique_ptr<XCanvas> Graphics::CreateCanvas(gfx::Rect size) const {
+  if (recording_) {
+    auto list = std::make_shared<DisplayList>();
+    Graphics graphics(context_, size);
+    graphics.SetRecording(list.get());
+    return std::make_unique<XCanvas>(std::move(list), std::move(graphics));
+  }
+
+  const uint32_t depth = context_->depth;
   std::shared_ptr<xlib::XPixmap> pixmap =
-      window_->XCreatePixmap(size.width, size.height, depth_);
-  Graphics graphics(pixmap->XCreateGC(colormap_), colormap_, laf_, window_,
-                    depth_, size);
-  return std::make_unique<XCanvas>(std::move(pixmap), std::move(graphics));
+      context_->window->AcquirePixmap(size.width, size.height, depth);
+  auto context = std::make_unique<RenderContext>(
+      pixmap->AcquireGC(context_->colormap, depth), context_->colormap,
+      context_->laf, context_->window, depth, context_->fonts);
+  context->pixels = context_->pixels;
+  return std::make_unique<XCanvas>(std::move(pixmap), std::move(context),
+                                   size);
 }
 
 void Graphics::FillRect(gfx::Coord at, gfx::Rect size) {
+  if (!occluded_.empty())
+    return FillAround(at, size);
+  if (recording_)
+    return recording_->Append(ops::FillRect{at + offset_, size});
   // TODO: use clamping utils of some sort
-  graphics_->XFillRectangle(offset_.x + at.x, offset_.y + at.y, size.width,
-                            size.height);
+  graphics_->QueueFillRectangle(offset_.x + at.x, offset_.y + at.y, size.width,
+                                size.height);
+}
+
+void Graphics::FillAround(gfx::Coord at, gfx::Rect size) {
+  // Painting runs inside the window's frame, so the pieces come out of its
+  // arena rather than the heap.
+  std::pmr::vector<gfx::Box> pieces(FrameArena::Current());
+  std::pmr::vector<gfx::Box> rest(FrameArena::Current());
+  pieces.push_back({at, size});
+  for (const gfx::Box& hole : occluded_) {
+    rest.clear();
+    for (const gfx::Box& piece : pieces)
+      gfx::Subtract(piece, hole, &rest);
+    std::swap(pieces, rest);
+    if (pieces.empty())
+      return;
+  }
+
+  std::span<const gfx::Box> occluded = std::exchange(occluded_, {});
+  for (const gfx::Box& piece : pieces)
+    FillRect(piece.top_left, piece.size);
+  occluded_ = occluded;
 }
 
 void Graphics::DrawRect(gfx::Coord at, gfx::Rect size) {
+  if (recording_)
+    return recording_->Append(ops::DrawRect{at + offset_, size});
   // TODO: use clamping utils of some sort
-  graphics_->XDrawRectangle(offset_.x + at.x, offset_.y + at.y, size.width,
-                            size.height);
+  graphics_->QueueDrawRectangle(offset_.x + at.x, offset_.y + at.y, size.width,
+                                size.height);
 }
 
 void Graphics::DrawRoundedRect(gfx::Coord at, gfx::Rect size, uint32_t radius) {
+  if (recording_)
+    return recording_->Append(ops::DrawRoundedRect{at + offset_, size, radius});
   uint32_t x = at.x + offset_.x;
   uint32_t y = at.y + offset_.y;
   uint32_t w = size.width;
   uint32_t h = size.height;
   graphics_->XSetLineAttributes(1, 0, 0, 0);
-  graphics_->XDrawLine(x + radius, y, x + w - radius, y);
-  graphics_->XDrawLine(x + radius, y + h - 1, x + w - radius, y + h - 1);
-  graphics_->XDrawLine(x + w, y + radius, x + w, y + h - radius);
-  graphics_->XDrawLine(x, y + radius, x, y + h - radius);
+  graphics_->QueueDrawLine(x + radius, y, x + w - radius, y);
+  graphics_->QueueDrawLine(x + radius, y + h - 1, x + w - radius, y + h - 1);
+  graphics_->QueueDrawLine(x + w, y + radius, x + w, y + h - radius);
+  graphics_->QueueDrawLine(x, y + radius, x, y + h - radius);
 
-  graphics_->XDrawArc(x, y, radius * 2, radius * 2, 180 * 64, -90 * 64);
-  graphics_->XDrawArc(x + w - radius * 2, y, radius * 2, radius * 2, 0,
-                      90 * 64);
-  graphics_->XDrawArc(x + w - radius * 2, y + h - radius * 2 - 1, radius * 2,
-                      radius * 2, 0, -90 * 64);
-  graphics_->XDrawArc(x, y + h - radius * 2 - 1, radius * 2, radius * 2,
-                      180 * 64, 90 * 64);
+  graphics_->QueueDrawArc(x, y, radius * 2, radius * 2, 180 * 64, -90 * 64);
+  graphics_->QueueDrawArc(x + w - radius * 2, y, radius * 2, radius * 2, 0,
+                          90 * 64);
+  graphics_->QueueDrawArc(x + w - radius * 2, y + h - radius * 2 - 1,
+                          radius * 2, radius * 2, 0, -90 * 64);
+  graphics_->QueueDrawArc(x, y + h - radius * 2 - 1, radius * 2, radius * 2,
+                          180 * 64, 90 * 64);
 }
 
 void Graphics::FillRoundedRect(gfx::Coord at, gfx::Rect size, uint32_t radius) {
+  if (recording_)
+    return recording_->Append(ops::FillRoundedRect{at + offset_, size, radius});
   uint32_t x = at.x + offset_.x;
   uint32_t y = at.y + offset_.y;
   uint32_t w = size.width;
   uint32_t h = size.height;
 
-  graphics_->XFillRectangle(x + radius, y, w - radius * 2, h);
-  graphics_->XFillRectangle(x, y + radius, w, h - radius * 2);
-  graphics_->XFillArc(x, y, radius * 2, radius * 2, 180 * 64, -90 * 64);
-  graphics_->XFillArc(x + w - radius * 2, y, radius * 2, radius * 2, 0,
-                      90 * 64);
-  graphics_->XFillArc(x + w - radius * 2, y + h - radius * 2 - 1, radius * 2,
-                      radius * 2, 0, -90 * 64);
-  graphics_->XFillArc(x, y + h - radius * 2 - 1, radius * 2, radius * 2,
-                      180 * 64, 90 * 64);
+  graphics_->QueueFillRectangle(x + radius, y, w - radius * 2, h);
+  graphics_->QueueFillRectangle(x, y + radius, w, h - radius * 2);
+  graphics_->QueueFillArc(x, y, radius * 2, radius * 2, 180 * 64, -90 * 64);
+  graphics_->QueueFillArc(x + w - radius * 2, y, radius * 2, radius * 2, 0,
+                          90 * 64);
+  graphics_->QueueFillArc(x + w - radius * 2, y + h - radius * 2 - 1,
+                          radius * 2, radius * 2, 0, -90 * 64);
+  graphics_->QueueFillArc(x, y + h - radius * 2 - 1, radius * 2, radius * 2,
+                          180 * 64, 90 * 64);
 }
 
-void Graphics::CopyArea(std::shared_ptr<xlib::XDrawable> d, gfx::Coord at) {
+void Graphics::FillGradient(gfx::Coord at,
+                            gfx::Rect size,
+                            const Gradient& gradient) {
+  if (recording_)
+    return recording_->Append(ops::FillGradient{at + offset_, size, gradient});
+  const int64_t x = at.x + offset_.x;
+  const int64_t y = at.y + offset_.y;
+  ForEachGradientBand(
+      gradient, size,
+      [&](gfx::Color color, const std::vector<GradientSpan>& spans) {
+        graphics_->XSetForeground(
+            laf_->GetPixel(context_->colormap, color, context_->pixels.get()));
+        for (const GradientSpan& span : spans) {
+          graphics_->QueueFillRectangle(x + span.x, y + span.y, span.width,
+                                        span.height);
+        }
+      });
+  graphics_->XSetForeground(
+      laf_->GetPixel(context_->colormap, color_, context_->pixels.get()));
+}
+
+void Graphics::CopyArea(const std::shared_ptr<xlib::XDrawable>& d,
+                        gfx::Coord at) {
   graphics_->XCopyArea(d->Drawable(), at.x, at.y, size_.width, size_.height,
                        offset_.x, offset_.y);
 }
 
-void Graphics::DrawText(gfx::Coord at, std::string message) {
+void Graphics::DrawRecording(std::shared_ptr<const DisplayList> list,
+                             gfx::Rect size,
+                             gfx::Coord at) {
+  if (recording_) {
+    return recording_->Append(
+        ops::Layer{std::move(list), size, at, offset_, size_});
+  }
+
+  auto canvas = CreateCanvas(size);
+  list->Replay(canvas->GetGraphics());
+  canvas->MapOnTo(this, at);
+}
+
+void Graphics::Flush() {
+  if (!recording_)
+    graphics_->FlushQueued();
+}
+
+void Graphics::SetOccluded(std::span<const gfx::Box> holes) {
+  occluded_ = holes;
+}
+
+void Graphics::SetRecording(DisplayList* list) {
+  recording_ = list;
+}
+
+bool Graphics::IsRecording() const {
+  return recording_ != nullptr;
+}
+
+void Graphics::DrawText(gfx::Coord at, std::string_view message) {
+  if (recording_) {
+    return recording_->Append(
+        ops::DrawText{at + offset_, std::string(message)});
+  }
   auto x = at.x + offset_.x;
   auto y = at.y + offset_.y;
   switch (font_.mode_) {
     case gfx::Font::TextRenderingMode::kXorg: {
-      graphics_->XDrawString(x, y + font_.Height(), message.c_str(),
+      graphics_->XDrawString(x, y + font_.Height(), message.data(),
                              message.length());
       return;
     }
     case gfx::Font::TextRenderingMode::kXFT: {
       auto xft_color = laf_->GetXFTColor(graphics_, color_);
-      XftDrawStringUtf8(
-          fonts_->xft_ctx, &xft_color, font_.xft_font_, x, y + font_.Height(),
-          (const unsigned char*)message.c_str(), message.length());
+      laf_->GetTextEngine()->Draw(graphics_, graphics_->GetXftDraw(),
+                                  &xft_color, font_, x, y + font_.Height(),
+                                  message);
       return;
     }
     default: {
@@ -175,8 +276,13 @@ Graphics Graphics::SubGraphics(gfx::Coord offset, gfx::Rect size) {
       std::min(size.height, max_height),
   };
 
-  return {graphics_, colormap_, laf_,       window_,
-          depth_,    new_size,  new_offset, fonts_};
+  Graphics sub(context_, new_size, new_offset);
+  if (recording_) {
+    // Sub-graphics start out on the default font; replay needs to know that.
+    sub.recording_ = recording_;
+    sub.SetFont(sub.font_);
+  }
+  return sub;
 }
 
 }  // namespace xpp::ui
\ No newline at end of file
@@ -1,70 +1,106 @@
 #pragma once
 
+#include <span>
+#include <string_view>
+#include <vector>
+
 #include "font.h"
+#include "gradient.h"
 #include "look_and_feel.h"
+#include "render_context.h"
 
 #include "../gfx/color.h"
 #include "../gfx/coord.h"
 #include "../gfx/rect.h"
+#include "../gfx/util.h"
 #include "../xlib/xgraphics.h"
 
 namespace xpp::ui {
 
+class DisplayList;
 class XCanvas;
 
+// Draws into |size| pixels at |offset| of a context it borrows; see
+// RenderContext for who keeps that alive.
 class Graphics {
  public:
-  Graphics(std::shared_ptr<xlib::XGraphics>,
-           std::shared_ptr<xlib::XColorMap>,
-           std::shared_ptr<LookAndFeel>,
-           std::shared_ptr<xlib::XWindow>,
-           uint32_t depth,
-           gfx::Rect size);
-
-  Graphics(std::shared_ptr<xlib::XGraphics>,
-           std::shared_ptr<xlib::XColorMap>,
-           std::shared_ptr<LookAndFeel>,
-           std::shared_ptr<xlib::XWindow> window,
-           uint32_t depth,
+  Graphics(RenderContext* context,
            gfx::Rect size,
-           gfx::Coord offset,
-           std::shared_ptr<LookAndFeel::FontCache> fonts);
+           gfx::Coord offset = {0, 0});
 
   void SetColor(gfx::Color color);
-  void SetColor(std::string name);
-  void SetFont(std::string font);
+  void SetColor(ThemeKey key);
+  void SetColor(std::string_view name);
+  void SetFont(std::string_view font);
   void SetFontSize(uint16_t size);
   void SetFont(gfx::Font font);
 
   gfx::Rect GetDimensions() const;
+  const gfx::Font& GetFont() const;
   uint32_t GetFontHeight() const;
 
+  // The size |message| would take up in the current font. Cached, so it is
+  // cheap enough to call from layout.
+  gfx::Rect MeasureText(std::string_view message) const;
+  // The width of every prefix of |message|, see
+  // TextEngine::MeasurePrefixes(). Not cached; meant for breaking one long
+  // piece of text without measuring each candidate separately.
+  void MeasurePrefixes(std::string_view message,
+                       std::vector<uint32_t>* widths) const;
+
   std::unique_ptr<XCanvas> CreateCanvas(gfx::Rect size) const;
 
   void FillRect(gfx::Coord at, gfx::Rect size);
   void DrawRect(gfx::Coord at, gfx::Rect size);
-  void DrawText(gfx::Coord at, std::string message);
+  // Only a recording keeps a copy of |message|.
+  void DrawText(gfx::Coord at, std::string_view message);
 
   void DrawRoundedRect(gfx::Coord at, gfx::Rect size, uint32_t radius);
   void FillRoundedRect(gfx::Coord at, gfx::Rect size, uint32_t radius);
 
-  void CopyArea(std::shared_ptr<xlib::XDrawable> d, gfx::Coord at);
+  // Paints |gradient| over the whole of |size|, one batch of rectangles per
+  // color. The current color is left as it was.
+  void FillGradient(gfx::Coord at, gfx::Rect size, const Gradient& gradient);
+
+  void CopyArea(const std::shared_ptr<xlib::XDrawable>& d, gfx::Coord at);
+
+  // Sends any primitives still queued on the underlying GC to the server.
+  void Flush();
+
+  // Draws |list| into an offscreen canvas of |size| and copies it in from
+  // |at|, the same way an XCanvas would have been mapped.
+  void DrawRecording(std::shared_ptr<const DisplayList> list,
+                     gfx::Rect size,
+                     gfx::Coord at);
+
+  // Once set, drawing calls are appended to |list| instead of being sent to
+  // the server. Canvases and sub-graphics made from this object record too.
+  void SetRecording(DisplayList* list);
+  bool IsRecording() const;
 
   Graphics SubGraphics(gfx::Coord at, gfx::Rect size);
 
+  // FillRect() leaves out |holes|, in this object's coordinates, because
+  // something opaque is about to be painted over them. Sub-graphics and
+  // canvases don't inherit them. |holes| has to outlive the painting.
+  void SetOccluded(std::span<const gfx::Box> holes);
+
  private:
-  std::shared_ptr<xlib::XGraphics> graphics_;
-  std::shared_ptr<xlib::XColorMap> colormap_;
-  std::shared_ptr<LookAndFeel> laf_;
-  std::shared_ptr<xlib::XWindow> window_;
-  std::shared_ptr<LookAndFeel::FontCache> fonts_;
+  void FillAround(gfx::Coord at, gfx::Rect size);
+
+  RenderContext* context_;
+  // Borrowed from |context_| for the paint path.
+  xlib::XGraphics* graphics_;
+  LookAndFeel* laf_;
 
-  uint32_t depth_;
   gfx::Rect size_;
   gfx::Coord offset_;
 
   gfx::Color color_ = gfx::Color::BLACK;
   gfx::Font font_;
+
+  DisplayList* recording_ = nullptr;
+  std::span<const gfx::Box> occluded_;
 };
 
 }  // namespace xpp::ui
\ No newline at end of file
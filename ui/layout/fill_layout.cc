@@ -1,13 +1,16 @@
 #include "fill_layout.h"
 
+#include "xpp/ui/frame_arena.h"
+
 namespace xpp::ui {
 
-std::vector<xpp::ui::Layout::Position> FillLayout::DoLayout(
+Layout::Positions FillLayout::DoLayout(
     std::vector<std::tuple<std::unique_ptr<XComponent>, int32_t>>& entries,
     gfx::Rect size) {
+  Positions positions(FrameArena::Current());
   if (entries.size())
-    return {{std::get<0>(entries[0]).get(), {0, 0}, size}};
-  return {};
+    positions.push_back({std::get<0>(entries[0]).get(), {0, 0}, size});
+  return positions;
 }
 
 }  // namespace xpp::ui
\ No newline at end of file
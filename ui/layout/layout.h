@@ -1,6 +1,7 @@
 #pragma once
 
 #include <memory>
+#include <memory_resource>
 #include <vector>
 
 #include "../../gfx/coord.h"
@@ -29,9 +30,13 @@ class Layout {
     Position() : Position(nullptr, {0, 0}) {}
   };
 
+  // Layouts are redone for every paint and every mouse event, so their
+  // results should come from the current FrameArena.
+  using Positions = std::pmr::vector<Position>;
+
   virtual ~Layout() = default;
 
-  virtual std::vector<Position> DoLayout(
+  virtual Positions DoLayout(
       std::vector<std::tuple<std::unique_ptr<XComponent>, int32_t>>& entries,
       gfx::Rect size) = 0;
 };
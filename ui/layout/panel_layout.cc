@@ -3,13 +3,14 @@
 #include <optional>
 
 #include "xpp/ui/component.h"
+#include "xpp/ui/frame_arena.h"
 
 namespace xpp::ui {
 
-std::vector<xpp::ui::Layout::Position> PanelLayout::DoLayout(
+Layout::Positions PanelLayout::DoLayout(
     std::vector<std::tuple<std::unique_ptr<XComponent>, int32_t>>& entries,
     gfx::Rect size) {
-  std::vector<xpp::ui::Layout::Position> positions;
+  Positions positions(FrameArena::Current());
   gfx::Coord tlc = {0, 0};
   for (const auto& tagged : entries) {
     const auto& comp = std::get<0>(tagged);
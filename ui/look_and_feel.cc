@@ -1,68 +1,63 @@
 #include "look_and_feel.h"
 
-#include <sstream>
-
 namespace xpp::ui {
 
-LookAndFeel::LookAndFeel() {
-  SetColor("PanelBackground", gfx::Color::GRAY8);
-  SetColor("PanelBorder", gfx::Color::GRAY6);
-  SetColor("TextColor", gfx::Color::BLACK);
-
-  SetColor("ButtonTextColor", gfx::Color::WHITE);
-  SetColor("ButtonBackground", gfx::Color::BLUE);
-  SetColor("ButtonShadow", gfx::Color::GRAY2);
-  SetColor("ButtonBorder", gfx::Color::GRAY5);
-
-  SetColor("ButtonHoveredTextColor", gfx::Color::WHITE);
-  SetColor("ButtonHoveredBackground", gfx::Color::BLUE.Darker());
-  SetColor("ButtonHoveredShadow", gfx::Color::GRAY2);
-  SetColor("ButtonHoveredBorder", gfx::Color::GRAY5);
-
-  SetColor("ButtonPressedTextColor", gfx::Color::WHITE);
-  SetColor("ButtonPressedBackground", gfx::Color::BLUE);
-  SetColor("ButtonPressedShadow", gfx::Color::GRAY2);
-  SetColor("ButtonPressedBorder", gfx::Color::GRAY5);
-
-  SetColor("ScrollbarTrackColor", gfx::Color::GRAY6);
-  SetColor("ScrollbarTrackBorderColor", gfx::Color::GRAY6);
-  SetColor("ScrollbarColor", gfx::Color::GRAY2);
-  SetColor("ScrollbarBorderColor", gfx::Color::GRAY4);
-  SetColor("ScrollbarHoveredColor", gfx::Color::BLUE);
-
-  SetColor("AccordionHeaderBackgroundColorOpen", gfx::Color::GRAY7);
-  SetColor("AccordionHeaderBackgroundColorClosed", gfx::Color::GRAY7);
-  SetColor("AccordionHeaderTextColorOpen", gfx::Color::GRAY1);
-  SetColor("AccordionHeaderTextColorClosed", gfx::Color::GRAY1);
-}
-
-LookAndFeel::FontCache::FontCache(std::shared_ptr<xlib::XGraphics> gc)
-    : gc_(gc) {}
-
-LookAndFeel::FontCache::~FontCache() {
-  if (xft_ctx)
-    XftDrawDestroy(xft_ctx);
-  for (auto& [_, font] : std::move(fonts)) {
-    font.DeleteEarly(gc_.get());
+namespace {
+
+// Indexed by ThemeKey::id(), so this has to follow the order in theme::.
+constexpr const char* kBuiltinKeyNames[theme::kBuiltinKeyCount] = {
+    "PanelBackground",
+    "PanelBorder",
+    "TextColor",
+    "ButtonTextColor",
+    "ButtonBackground",
+    "ButtonShadow",
+    "ButtonBorder",
+    "ButtonHoveredTextColor",
+    "ButtonHoveredBackground",
+    "ButtonHoveredShadow",
+    "ButtonHoveredBorder",
+    "ButtonPressedTextColor",
+    "ButtonPressedBackground",
+    "ButtonPressedShadow",
+    "ButtonPressedBorder",
+    "ScrollbarTrackColor",
+    "ScrollbarTrackBorderColor",
+    "ScrollbarColor",
+    "ScrollbarBorderColor",
+    "ScrollbarHoveredColor",
+    "AccordionHeaderBackgroundColorOpen",
+    "AccordionHeaderBackgroundColorClosed",
+    "AccordionHeaderTextColorOpen",
+    "AccordionHeaderTextColorClosed",
+};
+
+}  // namespace
+
+LookAndFeel::LookAndFeel(const theme::Palette& palette) {
+  theme_.reserve(theme::kBuiltinKeyCount);
+  for (uint16_t id = 0; id < theme::kBuiltinKeyCount; id++) {
+    theme_keys_.insert({kBuiltinKeyNames[id], ThemeKey(id)});
+    theme_.push_back({palette[id]});
   }
 }
 
-XColor LookAndFeel::GetXColor(std::shared_ptr<xlib::XColorMap> colormap,
-                              gfx::Color color) {
-  auto itr = xcolors_.find(color);
-  if (itr != xcolors_.end())
-    return itr->second;
-
-  XColor xcolor;
-  xcolor.red = color.red();
-  xcolor.blue = color.blue();
-  xcolor.green = color.green();
-  colormap->XAllocColor(&xcolor);
-  xcolors_[color] = xcolor;
-  return xcolor;
+unsigned long LookAndFeel::GetPixel(
+    const std::shared_ptr<xlib::XColorMap>& colormap,
+    gfx::Color color,
+    PixelCache* pixels) {
+  const uint64_t index = color.Index();
+  PixelCache::Slot& slot =
+      pixels->slots[(index * 0x9E3779B97F4A7C15ull) >> 56];
+  if (slot.index == index)
+    return slot.pixel;
+
+  slot.index = index;
+  slot.pixel = colormap->Pixel(color.red(), color.green(), color.blue());
+  return slot.pixel;
 }
 
-XftColor LookAndFeel::GetXFTColor(std::shared_ptr<xlib::XGraphics> gc,
+XftColor LookAndFeel::GetXFTColor(xlib::XGraphics* gc,
                                   gfx::Color color) {
   auto itr = xft_colors_.find(color);
   if (itr != xft_colors_.end())
@@ -78,42 +73,44 @@ XftColor LookAndFeel::GetXFTColor(std::shared_ptr<xlib::XGraphics> gc,
   return xft_color;
 }
 
-gfx::Font LookAndFeel::AllocateFont(std::shared_ptr<xlib::XGraphics> gc,
-                                    std::string name,
+gfx::Font LookAndFeel::AllocateFont(xlib::XGraphics* gc,
+                                    std::string_view name_view,
                                     uint16_t size,
                                     FontCache* fonts) {
-  std::stringstream stream;
-  stream << name << "::" << size;
-  std::string key = stream.str();
-
-  auto itr = fonts->fonts.find(key);
-  if (itr != fonts->fonts.end())
-    return itr->second;
+  auto by_name = fonts->fonts.find(name_view);
+  if (by_name != fonts->fonts.end()) {
+    auto itr = by_name->second.find(size);
+    if (itr != by_name->second.end())
+      return itr->second;
+  }
 
+  // Only a miss pays for a string.
+  std::string name(name_view);
   gfx::Font font;
 
+  // Another canvas on this display may already have it open. Only Xft fonts
+  // are ever cached, so this can't shadow a core font of the same name.
+  std::shared_ptr<xlib::XFontCache> cache = gc->GetFontCache();
+  font.xft_font_ = cache->Find(name, size);
+
   // try to allocate an XFont first, since it is simpler
-  font.xfont_ = gc->XLoadQueryFont(name.c_str());
+  if (!font.xft_font_)
+    font.xfont_ = gc->XLoadQueryFont(name.c_str());
   if (font.xfont_) {
     font.mode_ = gfx::Font::TextRenderingMode::kXorg;
-    fonts->fonts[key] = font;
+    fonts->fonts[name][size] = font;
     return font;
   }
 
   // If it failed, use an XFT font
-  std::stringstream fontstr;
-  fontstr << name << ":size=" << size;
-  font.xft_font_ = gc->XftFontOpenName(fontstr.str().c_str());
+  if (!font.xft_font_)
+    font.xft_font_ = cache->Open(name, size);
 
   if (font.xft_font_) {
-    if (!fonts->xft_ctx)
-      fonts->xft_ctx = gc->XftDrawCreate();
-    if (fonts->xft_ctx) {
-      font.mode_ = gfx::Font::TextRenderingMode::kXFT;
-      font.size_ = size;
-      font.font_name_ = name;
-      fonts->fonts[key] = font;
-    }
+    font.mode_ = gfx::Font::TextRenderingMode::kXFT;
+    font.size_ = size;
+    font.font_name_ = name;
+    fonts->fonts[name][size] = font;
     return font;
   }
 
@@ -121,29 +118,59 @@ gfx::Font LookAndFeel::AllocateFont(std::shared_ptr<xlib::XGraphics> gc,
   return font;
 }
 
-gfx::Font LookAndFeel::GetFont(std::shared_ptr<xlib::XGraphics> gc,
-                               std::string name,
-                               gfx::Font existing,
+gfx::Font LookAndFeel::GetFont(xlib::XGraphics* gc,
+                               std::string_view name,
+                               const gfx::Font& existing,
                                FontCache* fonts) {
   return AllocateFont(gc, name, existing.size_, fonts);
 }
 
-gfx::Font LookAndFeel::GetFont(std::shared_ptr<xlib::XGraphics> gc,
+gfx::Font LookAndFeel::GetFont(xlib::XGraphics* gc,
                                uint16_t size,
-                               gfx::Font existing,
+                               const gfx::Font& existing,
                                FontCache* fonts) {
   return AllocateFont(gc, existing.font_name_, size, fonts);
 }
 
-gfx::Color LookAndFeel::GetColorByName(std::string color) {
-  auto itr = colors_.find(color);
-  if (itr != colors_.end())
+ThemeKey LookAndFeel::Intern(std::string_view name) {
+  auto itr = theme_keys_.find(name);
+  if (itr != theme_keys_.end())
     return itr->second;
+
+  ThemeKey key(static_cast<uint16_t>(theme_.size()));
+  theme_.push_back({gfx::Color::BLACK});
+  theme_keys_.emplace(name, key);
+  return key;
+}
+
+gfx::Color LookAndFeel::GetColor(ThemeKey key) const {
+  return theme_[key.id()].color;
+}
+
+unsigned long LookAndFeel::GetPixel(
+    const std::shared_ptr<xlib::XColorMap>& colormap,
+    ThemeKey key,
+    PixelCache* pixels) {
+  return GetPixel(colormap, theme_[key.id()].color, pixels);
+}
+
+void LookAndFeel::SetColor(ThemeKey key, gfx::Color color) {
+  theme_[key.id()] = {color};
+}
+
+gfx::Color LookAndFeel::GetColorByName(std::string_view color) {
+  auto itr = theme_keys_.find(color);
+  if (itr != theme_keys_.end())
+    return GetColor(itr->second);
   return gfx::Color::BLACK;
 }
 
-void LookAndFeel::SetColor(std::string name, gfx::Color color) {
-  colors_[name] = color;
+void LookAndFeel::SetColor(std::string_view name, gfx::Color color) {
+  SetColor(Intern(name), color);
+}
+
+TextEngine* LookAndFeel::GetTextEngine() {
+  return &text_engine_;
 }
 
 }  // namespace xpp::ui
\ No newline at end of file
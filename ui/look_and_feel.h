@@ -1,59 +1,181 @@
 #pragma once
 
+#include <array>
 #include <map>
 #include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
 
 #include "../gfx/color.h"
 #include "../xlib/xgraphics.h"
 #include "font.h"
+#include "text_engine.h"
 
 namespace xpp::ui {
 
 class Graphics;
 
-class LookAndFeel {
+// A theme color name, interned into an index into the LookAndFeel's flat
+// color table so the paint path never hashes or compares strings.
+class ThemeKey {
  public:
-  const gfx::Color PanelBackground = gfx::Color::GRAY8;
+  constexpr explicit ThemeKey(uint16_t id) : id_(id) {}
+  constexpr uint16_t id() const { return id_; }
+
+ private:
+  uint16_t id_;
+};
+
+// The keys every LookAndFeel knows about. Anything else is registered at
+// runtime through LookAndFeel::Intern.
+namespace theme {
+
+inline constexpr ThemeKey kPanelBackground{0};
+inline constexpr ThemeKey kPanelBorder{1};
+inline constexpr ThemeKey kTextColor{2};
+inline constexpr ThemeKey kButtonTextColor{3};
+inline constexpr ThemeKey kButtonBackground{4};
+inline constexpr ThemeKey kButtonShadow{5};
+inline constexpr ThemeKey kButtonBorder{6};
+inline constexpr ThemeKey kButtonHoveredTextColor{7};
+inline constexpr ThemeKey kButtonHoveredBackground{8};
+inline constexpr ThemeKey kButtonHoveredShadow{9};
+inline constexpr ThemeKey kButtonHoveredBorder{10};
+inline constexpr ThemeKey kButtonPressedTextColor{11};
+inline constexpr ThemeKey kButtonPressedBackground{12};
+inline constexpr ThemeKey kButtonPressedShadow{13};
+inline constexpr ThemeKey kButtonPressedBorder{14};
+inline constexpr ThemeKey kScrollbarTrackColor{15};
+inline constexpr ThemeKey kScrollbarTrackBorderColor{16};
+inline constexpr ThemeKey kScrollbarColor{17};
+inline constexpr ThemeKey kScrollbarBorderColor{18};
+inline constexpr ThemeKey kScrollbarHoveredColor{19};
+inline constexpr ThemeKey kAccordionHeaderBackgroundColorOpen{20};
+inline constexpr ThemeKey kAccordionHeaderBackgroundColorClosed{21};
+inline constexpr ThemeKey kAccordionHeaderTextColorOpen{22};
+inline constexpr ThemeKey kAccordionHeaderTextColorClosed{23};
+
+inline constexpr uint16_t kBuiltinKeyCount = 24;
+
+// A color for every builtin key, indexed by ThemeKey::id().
+using Palette = std::array<gfx::Color, kBuiltinKeyCount>;
+
+constexpr Palette MakeDefaultPalette() {
+  Palette palette;
+  palette[kPanelBackground.id()] = gfx::Color::GRAY8;
+  palette[kPanelBorder.id()] = gfx::Color::GRAY6;
+  palette[kTextColor.id()] = gfx::Color::BLACK;
+
+  palette[kButtonTextColor.id()] = gfx::Color::WHITE;
+  palette[kButtonBackground.id()] = gfx::Color::BLUE;
+  palette[kButtonShadow.id()] = gfx::Color::GRAY2;
+  palette[kButtonBorder.id()] = gfx::Color::GRAY5;
+
+  palette[kButtonHoveredTextColor.id()] = gfx::Color::WHITE;
+  palette[kButtonHoveredBackground.id()] = gfx::Color::BLUE.Darker();
+  palette[kButtonHoveredShadow.id()] = gfx::Color::GRAY2;
+  palette[kButtonHoveredBorder.id()] = gfx::Color::GRAY5;
+
+  palette[kButtonPressedTextColor.id()] = gfx::Color::WHITE;
+  palette[kButtonPressedBackground.id()] = gfx::Color::BLUE;
+  palette[kButtonPressedShadow.id()] = gfx::Color::GRAY2;
+  palette[kButtonPressedBorder.id()] = gfx::Color::GRAY5;
+
+  palette[kScrollbarTrackColor.id()] = gfx::Color::GRAY6;
+  palette[kScrollbarTrackBorderColor.id()] = gfx::Color::GRAY6;
+  palette[kScrollbarColor.id()] = gfx::Color::GRAY2;
+  palette[kScrollbarBorderColor.id()] = gfx::Color::GRAY4;
+  palette[kScrollbarHoveredColor.id()] = gfx::Color::BLUE;
 
-  class FontCache {
-   public:
-    FontCache(std::shared_ptr<xlib::XGraphics> gc);
-    ~FontCache();
+  palette[kAccordionHeaderBackgroundColorOpen.id()] = gfx::Color::GRAY7;
+  palette[kAccordionHeaderBackgroundColorClosed.id()] = gfx::Color::GRAY7;
+  palette[kAccordionHeaderTextColorOpen.id()] = gfx::Color::GRAY1;
+  palette[kAccordionHeaderTextColorClosed.id()] = gfx::Color::GRAY1;
+  return palette;
+}
 
-    std::map<std::string, gfx::Font> fonts;
-    XftDraw* xft_ctx = nullptr;
+// Evaluated entirely at compile time; constructing a LookAndFeel only copies
+// it into the theme table.
+inline constexpr Palette kDefaultPalette = MakeDefaultPalette();
 
-   private:
-    std::shared_ptr<xlib::XGraphics> gc_;
+}  // namespace theme
+
+class LookAndFeel {
+ public:
+
+  // Fonts already resolved for one tree of Graphics objects. The fonts are
+  // owned by the display's XFontCache, and text is drawn through the
+  // colormap's shared XftDraw.
+  struct FontCache {
+    // By name, then by size. Looked up with a string_view, so finding a font
+    // that is already resolved doesn't build a key.
+    std::map<std::string, std::map<uint16_t, gfx::Font>, std::less<>> fonts;
+  };
+
+  // Pixels already allocated, for one drawing thread. The look and feel is
+  // shared with the render thread, so this lives in the RenderContext.
+  // Direct-mapped on Color::Index(); a collision just evicts the old entry.
+  struct PixelCache {
+    struct Slot {
+      uint64_t index = ~uint64_t{0};
+      unsigned long pixel = 0;
+    };
+    std::array<Slot, 256> slots;
   };
 
  public:
-  LookAndFeel();
+  static constexpr const char* kDefaultFont = "Fantasque Sans Mono";
+  static constexpr uint16_t kDefaultFontSize = 10;
 
-  gfx::Font GetFont(std::shared_ptr<xlib::XGraphics> gc,
-                    std::string name,
-                    gfx::Font existing,
+  explicit LookAndFeel(const theme::Palette& palette = theme::kDefaultPalette);
+
+  gfx::Font GetFont(xlib::XGraphics* gc,
+                    std::string_view name,
+                    const gfx::Font& existing,
                     FontCache* fonts);
-  gfx::Font GetFont(std::shared_ptr<xlib::XGraphics> gc,
+  gfx::Font GetFont(xlib::XGraphics* gc,
                     uint16_t size,
-                    gfx::Font existing,
+                    const gfx::Font& existing,
                     FontCache* fonts);
-  gfx::Font AllocateFont(std::shared_ptr<xlib::XGraphics> gc,
-                         std::string name,
+  gfx::Font AllocateFont(xlib::XGraphics* gc,
+                         std::string_view name,
                          uint16_t size,
                          FontCache* fonts);
 
-  XColor GetXColor(std::shared_ptr<xlib::XColorMap>, gfx::Color);
-  XftColor GetXFTColor(std::shared_ptr<xlib::XGraphics>, gfx::Color);
-  gfx::Color GetColorByName(std::string);
-  void SetColor(std::string, gfx::Color);
+  unsigned long GetPixel(const std::shared_ptr<xlib::XColorMap>&,
+                         gfx::Color,
+                         PixelCache* pixels);
+  XftColor GetXFTColor(xlib::XGraphics*, gfx::Color);
+
+  // Returns the key for |name|, registering it (as black) if it is new.
+  ThemeKey Intern(std::string_view name);
+  gfx::Color GetColor(ThemeKey key) const;
+  unsigned long GetPixel(const std::shared_ptr<xlib::XColorMap>&,
+                         ThemeKey,
+                         PixelCache* pixels);
+  void SetColor(ThemeKey key, gfx::Color color);
+
+  // Shared by every Graphics drawing for this look and feel.
+  TextEngine* GetTextEngine();
+
+  // String lookups; kept for compatibility, but not for the paint path.
+  gfx::Color GetColorByName(std::string_view);
+  void SetColor(std::string_view, gfx::Color);
 
  private:
   friend class Graphics;
 
-  std::map<std::string, gfx::Color> colors_;
-  std::map<gfx::Color, XColor> xcolors_;
+  struct ThemeEntry {
+    gfx::Color color;
+  };
+
+  // Only the painting thread reads the theme; recorded frames carry plain
+  // colors to the render thread.
+  std::map<std::string, ThemeKey, std::less<>> theme_keys_;
+  std::vector<ThemeEntry> theme_;
   std::map<gfx::Color, XftColor> xft_colors_;
+  TextEngine text_engine_;
 };
 
 }  // namespace xpp::ui
\ No newline at end of file
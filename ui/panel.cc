@@ -8,10 +8,14 @@ XPanel::XPanel() : XContainer() {
   SetLayout(std::make_unique<PanelLayout>());
 }
 
-void XPanel::Paint(xpp::ui::Graphics* g) {
-  g->SetColor("PanelBackground");
+void XPanel::PaintContents(xpp::ui::Graphics* g) {
+  g->SetColor(theme::kPanelBackground);
   g->FillRect({0, 0}, g->GetDimensions());
-  XContainer::Paint(g);
+  XContainer::PaintContents(g);
+}
+
+bool XPanel::IsOpaque() const {
+  return true;
 }
 
 gfx::Rect XPanel::CalculatePreferredSize() const {
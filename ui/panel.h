@@ -8,7 +8,9 @@ class XPanel : public XContainer {
  public:
   XPanel();
   ~XPanel() override = default;
-  void Paint(xpp::ui::Graphics* g) override;
+  void PaintContents(xpp::ui::Graphics* g) override;
+  // Panels fill their background, and so do subclasses that paint their own.
+  bool IsOpaque() const override;
   gfx::Rect CalculatePreferredSize() const;
   std::string GetTypeName() const override;
 };
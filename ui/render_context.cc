@@ -0,0 +1,22 @@
+#include "render_context.h"
+
+namespace xpp::ui {
+
+RenderContext::RenderContext(std::shared_ptr<xlib::XGraphics> graphics,
+                             std::shared_ptr<xlib::XColorMap> colormap,
+                             std::shared_ptr<LookAndFeel> laf,
+                             std::shared_ptr<xlib::XWindow> window,
+                             uint32_t depth,
+                             std::shared_ptr<LookAndFeel::FontCache> fonts)
+    : graphics(std::move(graphics)),
+      colormap(std::move(colormap)),
+      laf(std::move(laf)),
+      window(std::move(window)),
+      fonts(std::move(fonts)),
+      depth(depth) {
+  default_font = this->laf->AllocateFont(
+      this->graphics.get(), LookAndFeel::kDefaultFont,
+      LookAndFeel::kDefaultFontSize, this->fonts.get());
+}
+
+}  // namespace xpp::ui
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <memory>
+
+#include "font.h"
+#include "look_and_feel.h"
+
+#include "../xlib/xcolormap.h"
+#include "../xlib/xgraphics.h"
+#include "../xlib/xwindow.h"
+
+namespace xpp::ui {
+
+// Everything the Graphics of one drawing target share. Whoever makes a
+// context owns it and keeps it alive for as long as any Graphics drawing
+// with it; the Graphics only borrow it, so handing out sub-graphics while
+// painting doesn't touch a single reference count.
+struct RenderContext {
+  RenderContext(std::shared_ptr<xlib::XGraphics> graphics,
+                std::shared_ptr<xlib::XColorMap> colormap,
+                std::shared_ptr<LookAndFeel> laf,
+                std::shared_ptr<xlib::XWindow> window,
+                uint32_t depth,
+                std::shared_ptr<LookAndFeel::FontCache> fonts);
+
+  std::shared_ptr<xlib::XGraphics> graphics;
+  std::shared_ptr<xlib::XColorMap> colormap;
+  std::shared_ptr<LookAndFeel> laf;
+  std::shared_ptr<xlib::XWindow> window;
+  std::shared_ptr<LookAndFeel::FontCache> fonts;
+  // Shared with the contexts of canvases made from this one, which draw on
+  // the same thread.
+  std::shared_ptr<LookAndFeel::PixelCache> pixels =
+      std::make_shared<LookAndFeel::PixelCache>();
+  uint32_t depth;
+
+  // What every Graphics starts out drawing text with, resolved once.
+  gfx::Font default_font;
+};
+
+}  // namespace xpp::ui
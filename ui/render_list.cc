@@ -0,0 +1,184 @@
+#include "render_list.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+
+#include "canvas.h"
+#include "container.h"
+
+namespace xpp::ui {
+
+namespace {
+
+// Past these, a frame spends more time testing against occluders and
+// cutting fills around holes than it would save.
+constexpr size_t kMaxOccluders = 32;
+constexpr size_t kMaxHoles = 32;
+
+uint64_t Area(gfx::Rect size) {
+  return uint64_t{size.width} * size.height;
+}
+
+}  // namespace
+
+RenderList::RenderList() : report_overdraw_(std::getenv("XPP_OVERDRAW")) {}
+
+void RenderList::Build(XContainer* root, gfx::Rect size) {
+  nodes_.clear();
+  holes_.clear();
+  size_ = size;
+  Append(root, {0, 0}, size);
+  Cull();
+  valid_ = true;
+}
+
+void RenderList::Append(XComponent* component,
+                        gfx::Coord offset,
+                        gfx::Rect clip) {
+  // Layouts may look at the size their container was last painted at.
+  component->SetDimensions(clip);
+  if (!component->HasFlatChildren()) {
+    nodes_.push_back({component, offset, clip, false});
+    return;
+  }
+  const size_t index = nodes_.size();
+  nodes_.push_back({component, offset, clip, true});
+
+  auto* container = static_cast<XContainer*>(component);
+  const gfx::Coord scroll = container->GetContentOffset();
+  Layout::Positions positions =
+      container->LayoutChildren(container->GetContentSize(clip));
+  std::stable_sort(positions.begin(), positions.end(),
+                   [](const Layout::Position& a, const Layout::Position& b) {
+                     return a.z_index < b.z_index;
+                   });
+  // The part of a child that shows, in the container's coordinates.
+  auto place = [clip, scroll](const Layout::Position& position) -> gfx::Box {
+    const gfx::Coord at = position.at - scroll;
+    const int64_t x = std::clamp<int64_t>(at.x, 0, clip.width);
+    const int64_t y = std::clamp<int64_t>(at.y, 0, clip.height);
+    const int64_t right =
+        std::min<int64_t>(at.x + position.size.width, clip.width);
+    const int64_t bottom =
+        std::min<int64_t>(at.y + position.size.height, clip.height);
+    return {{x, y},
+            {static_cast<uint32_t>(std::max<int64_t>(right - x, 0)),
+             static_cast<uint32_t>(std::max<int64_t>(bottom - y, 0))}};
+  };
+
+  nodes_[index].holes_begin = holes_.size();
+  for (const Layout::Position& position : positions) {
+    if (nodes_[index].holes_count == kMaxHoles)
+      break;
+    const gfx::Box box = place(position);
+    if (Area(box.size) && position.component->IsOpaque()) {
+      holes_.push_back(box);
+      nodes_[index].holes_count++;
+    }
+  }
+
+  for (const Layout::Position& position : positions) {
+    const gfx::Box box = place(position);
+    // Scrolled out of sight, along with anything under it.
+    if (!Area(box.size))
+      continue;
+    const gfx::Coord at = position.at - scroll;
+    const gfx::Coord cut = {std::max<int64_t>(-at.x, 0),
+                            std::max<int64_t>(-at.y, 0)};
+    if (cut == gfx::Coord{0, 0}) {
+      Append(position.component, offset + box.top_left, box.size);
+      continue;
+    }
+    position.component->SetDimensions(position.size);
+    Node& node = nodes_.emplace_back(
+        Node{position.component, offset + box.top_left, box.size, false});
+    node.cut = cut;
+    node.whole = position.size;
+  }
+}
+
+void RenderList::Cull() {
+  std::vector<gfx::Box> occluders;
+  for (auto node = nodes_.rbegin(); node != nodes_.rend(); ++node) {
+    const gfx::Box box = {node->offset, node->clip};
+    node->culled =
+        !Area(node->clip) ||
+        std::any_of(occluders.begin(), occluders.end(),
+                    [&](const gfx::Box& o) { return gfx::Contains(o, box); });
+    if (!node->culled && occluders.size() < kMaxOccluders &&
+        node->component->IsOpaque()) {
+      occluders.push_back(box);
+    }
+  }
+}
+
+void RenderList::Paint(Graphics* g) {
+  for (const Node& node : nodes_) {
+    if (node.culled)
+      continue;
+    Graphics sub = g->SubGraphics(node.offset, node.clip);
+    if (!(node.cut == gfx::Coord{0, 0})) {
+      auto canvas = sub.CreateCanvas(node.whole);
+      node.component->Paint(canvas->GetGraphics());
+      canvas->MapOnTo(&sub, node.cut);
+      continue;
+    }
+    if (!node.contents_only) {
+      node.component->Paint(&sub);
+      continue;
+    }
+    sub.SetOccluded({holes_.data() + node.holes_begin, node.holes_count});
+    static_cast<XContainer*>(node.component)->PaintContents(&sub);
+  }
+  if (report_overdraw_)
+    ReportOverdraw();
+}
+
+void RenderList::ReportOverdraw() {
+  const uint64_t area = Area(size_);
+  if (!area)
+    return;
+  uint64_t painted = 0;
+  uint64_t unculled = 0;
+  size_t culled = 0;
+  for (const Node& node : nodes_) {
+    unculled += Area(node.clip);
+    if (node.culled) {
+      culled++;
+      continue;
+    }
+    uint64_t covered = 0;
+    for (uint32_t i = 0; i < node.holes_count; i++)
+      covered += Area(holes_[node.holes_begin + i].size);
+    painted += Area(node.clip) - std::min(covered, Area(node.clip));
+  }
+  overdraw_ = static_cast<double>(painted) / area;
+  fprintf(stderr,
+          "render list: overdraw %.2fx (%.2fx without culling), %zu of %zu "
+          "nodes culled\n",
+          overdraw_, static_cast<double>(unculled) / area, culled,
+          nodes_.size());
+}
+
+void RenderList::Invalidate() {
+  valid_ = false;
+}
+
+bool RenderList::IsValid() const {
+  return valid_;
+}
+
+const std::vector<RenderList::Node>& RenderList::GetNodes() const {
+  return nodes_;
+}
+
+double RenderList::GetOverdrawRatio() const {
+  return overdraw_;
+}
+
+void RenderList::SetReportOverdraw(bool report) {
+  report_overdraw_ = report;
+}
+
+}  // namespace xpp::ui
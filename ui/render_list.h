@@ -0,0 +1,82 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "../gfx/coord.h"
+#include "../gfx/rect.h"
+#include "../gfx/util.h"
+
+namespace xpp::ui {
+
+class Graphics;
+class XComponent;
+class XContainer;
+
+// A component tree flattened into paint order. Building it runs every
+// layout in the tree once; painting from it is a walk down an array, with
+// no layouts, sorting or recursion. It only has to be rebuilt when the tree
+// or its layout changes, see XComponent::InvalidateLayout().
+//
+// Scrolling containers are flattened too, see
+// XContainer::GetContentOffset(); only their children that straddle the top
+// or left edge are painted offscreen.
+//
+// Building also works out what is hidden: a node that something opaque
+// painted after it covers completely is skipped, and a container's
+// background fills leave out its opaque children.
+class RenderList {
+ public:
+  struct Node {
+    XComponent* component;
+    // In the root's coordinates, and clipped to the ancestors the way
+    // Graphics::SubGraphics() would have.
+    gfx::Coord offset;
+    gfx::Rect clip;
+    // A container whose children follow as nodes of their own, so only its
+    // PaintContents() is called.
+    bool contents_only;
+    // Covered by opaque nodes later in the list.
+    bool culled = false;
+    // This node's opaque children, in its own coordinates, as a range of
+    // |holes_|.
+    uint32_t holes_begin = 0;
+    uint32_t holes_count = 0;
+    // For a child that a scrolled container cuts off at its top or left:
+    // how far into the child |clip| starts, and the child's whole size. It
+    // is painted offscreen and the visible part copied in.
+    gfx::Coord cut = {0, 0};
+    gfx::Rect whole = {0, 0};
+  };
+
+  // Set XPP_OVERDRAW in the environment to have every Paint() print how
+  // many times over the root's area it painted, with and without culling.
+  RenderList();
+
+  void Build(XContainer* root, gfx::Rect size);
+  void Paint(Graphics* g);
+
+  void Invalidate();
+  bool IsValid() const;
+  const std::vector<Node>& GetNodes() const;
+
+  // Area painted by the last Paint() over the area of the root. Only kept
+  // up when overdraw reporting is on.
+  double GetOverdrawRatio() const;
+  void SetReportOverdraw(bool report);
+
+ private:
+  void Append(XComponent* component, gfx::Coord offset, gfx::Rect clip);
+  void Cull();
+  void ReportOverdraw();
+
+  std::vector<Node> nodes_;
+  std::vector<gfx::Box> holes_;
+  gfx::Rect size_ = {0, 0};
+  bool valid_ = false;
+
+  bool report_overdraw_ = false;
+  double overdraw_ = 0;
+};
+
+}  // namespace xpp::ui
@@ -1,6 +1,6 @@
 #include "scroll_panel.h"
 
-#include "canvas.h"
+#include "frame_arena.h"
 #include "layout/panel_layout.h"
 
 namespace xpp::ui {
@@ -59,12 +59,12 @@ void ScrollWheelListener::WheelScrolled(MouseWheelEvent* event) {
 void ScrollBar::Paint(Graphics* g) {
   XComponent::Paint(g);
   if (hovered_)
-    g->SetColor("ScrollbarHoveredColor");
+    g->SetColor(theme::kScrollbarHoveredColor);
   else
-    g->SetColor("ScrollbarColor");
+    g->SetColor(theme::kScrollbarColor);
 
   g->FillRoundedRect({0, 0}, g->GetDimensions(), 5);
-  g->SetColor("ScrollbarBorderColor");
+  g->SetColor(theme::kScrollbarBorderColor);
   g->DrawRoundedRect({0, 0}, g->GetDimensions(), 5);
 }
 
@@ -91,8 +91,8 @@ ScrollBarTrack::ScrollBarTrack(XScrollPanel* panel, Mode mode)
   this->AddComponent(std::make_unique<ScrollBar>(panel, mode));
 }
 
-void ScrollBarTrack::Paint(Graphics* g) {
-  g->SetColor("ScrollbarTrackColor");
+void ScrollBarTrack::PaintContents(Graphics* g) {
+  g->SetColor(theme::kScrollbarTrackColor);
   auto box_size = g->GetDimensions();
   uint8_t width = 18;
   gfx::Rect roundedsize = {0, 0};
@@ -107,19 +107,19 @@ void ScrollBarTrack::Paint(Graphics* g) {
 
   g->FillRoundedRect({margin, margin}, roundedsize, 5);
 
-  g->SetColor("ScrollbarTrackBorderColor");
+  g->SetColor(theme::kScrollbarTrackBorderColor);
   g->DrawRoundedRect({margin, margin}, roundedsize, 5);
-  XContainer::Paint(g);
+  XContainer::PaintContents(g);
 }
 
 ScrollBarTrackLayout::ScrollBarTrackLayout(XScrollPanel* panel,
                                            ScrollBarTrack::Mode mode)
     : Layout(), panel_(panel), mode_(mode) {}
 
-std::vector<Layout::Position> ScrollBarTrackLayout::DoLayout(
+Layout::Positions ScrollBarTrackLayout::DoLayout(
     std::vector<std::tuple<std::unique_ptr<XComponent>, int32_t>>& entries,
     gfx::Rect size) {
-  std::vector<Layout::Position> result;
+  Positions result(FrameArena::Current());
   if (entries.size() != 1)
     return result;
 
@@ -181,10 +181,10 @@ std::vector<Layout::Position> ScrollBarTrackLayout::DoLayout(
 ScrollPanelLayout::ScrollPanelLayout(XScrollPanel* panel)
     : Layout(), panel_(panel) {}
 
-std::vector<Layout::Position> ScrollPanelLayout::DoLayout(
+Layout::Positions ScrollPanelLayout::DoLayout(
     std::vector<std::tuple<std::unique_ptr<XComponent>, int32_t>>& entries,
     gfx::Rect size) {
-  std::vector<Layout::Position> result;
+  Positions result(FrameArena::Current());
   CHECK(entries.size() == 3);
 
   gfx::Rect viewport_extent = panel_->ViewportExtents();
@@ -240,7 +240,7 @@ ScrollPanelViewport::ScrollPanelViewport(XScrollPanel* panel)
 gfx::Rect ScrollPanelViewport::GetCanvasSize(gfx::Rect size) const {
   uint32_t height = 0;
   uint32_t width = 0;
-  for (const auto& comp_key : components_) {
+  for (const auto& comp_key : GetComponents()) {
     const auto& component = std::get<0>(comp_key);
     const gfx::Rect actual = DeterminePaintSize(component.get(), size);
 
@@ -264,26 +264,12 @@ std::string ScrollPanelViewport::GetTypeName() const {
   return "SPV";
 }
 
-void ScrollPanelViewport::Paint(Graphics* g) {
-  // Skip the container paint routine - we want to redo the layout ourselves.
-  XComponent::Paint(g);
-  g->SetColor("PanelBackground");
-  g->FillRect({0, 0}, g->GetDimensions());
-
-  // Dimensions we are given to draw in
-  auto viewport = g->GetDimensions();
-
-  // Dimensions of the underlying content
-  auto content = GetCanvasSize(viewport);
-
-  // Grab a canvas that can fit the underlying content
-  auto canvas = g->CreateCanvas(content);
-
-  // draw the panel layout stuff into the canvas
-  XPanel::Paint(canvas->GetGraphics());
+gfx::Rect ScrollPanelViewport::GetContentSize(gfx::Rect size) {
+  return GetCanvasSize(size);
+}
 
-  // Let the canvas write itself into our graphics object
-  canvas->MapOnTo(g, panel_->ScrollPosition());
+gfx::Coord ScrollPanelViewport::GetContentOffset() {
+  return panel_->ScrollPosition();
 }
 
 gfx::Coord ScrollPanelViewport::FixLocation(gfx::Coord loc) {
@@ -361,12 +347,12 @@ XScrollPanel::XScrollPanel() : XPanel() {
 
   container_ = container.get();
 
-  components_.push_back(std::make_tuple(
-      std::move(v_track), static_cast<int>(ComponentUsage::kScrollVert)));
-  components_.push_back(std::make_tuple(
-      std::move(h_track), static_cast<int>(ComponentUsage::kScrollHoriz)));
-  components_.push_back(std::make_tuple(
-      std::move(container), static_cast<int>(ComponentUsage::kViewport)));
+  AppendComponent(std::move(v_track),
+                  static_cast<int>(ComponentUsage::kScrollVert));
+  AppendComponent(std::move(h_track),
+                  static_cast<int>(ComponentUsage::kScrollHoriz));
+  AppendComponent(std::move(container),
+                  static_cast<int>(ComponentUsage::kViewport));
 }
 
 gfx::Rect XScrollPanel::ViewportExtents() {
@@ -394,6 +380,22 @@ void XScrollPanel::RemoveAll() {
   container_->RemoveAll();
 }
 
+void XScrollPanel::ReplaceComponents(
+    size_t position,
+    size_t count,
+    std::vector<std::unique_ptr<XComponent>> components,
+    int32_t key) {
+  container_->ReplaceComponents(position, count, std::move(components), key);
+}
+
+void XScrollPanel::BeginUpdate() {
+  container_->BeginUpdate();
+}
+
+void XScrollPanel::EndUpdate() {
+  container_->EndUpdate();
+}
+
 void XScrollPanel::SetLayout(std::unique_ptr<Layout> layout) {
   container_->SetLayout(std::move(layout));
 }
@@ -421,6 +423,8 @@ void XScrollPanel::Scroll(gfx::Coord vec) {
   max_height -= canvas_height;
   position_ = {std::max(0l, std::min(max_width, position_.x + vec.x)),
                std::max(0l, std::min(max_height, position_.y + vec.y))};
+  // The scrollbars are laid out from the position.
+  InvalidateLayout();
   Repaint();
 }
 
@@ -11,8 +11,11 @@ namespace internal {
 class ScrollPanelViewport : public XPanel {
  public:
   ScrollPanelViewport(XScrollPanel* panel);
-  void Paint(Graphics* g) override;
   gfx::Rect GetCanvasSize(gfx::Rect size) const;
+  // Lays the children out on the whole canvas, shifted by the scroll
+  // position.
+  gfx::Rect GetContentSize(gfx::Rect size) override;
+  gfx::Coord GetContentOffset() override;
   std::string GetTypeName() const override;
 
   virtual void MouseEntered(MouseMotionEvent*) override;
@@ -33,7 +36,7 @@ class ScrollBarTrack : public XContainer {
  public:
   enum Mode { kVertical, kHorizontal };
   ScrollBarTrack(XScrollPanel* panel, Mode mode);
-  void Paint(Graphics* g) override;
+  void PaintContents(Graphics* g) override;
 
  private:
   Mode mode_;
@@ -56,7 +59,7 @@ class ScrollBar : public XComponent {
 class ScrollPanelLayout : public Layout {
  public:
   ScrollPanelLayout(XScrollPanel* panel);
-  virtual std::vector<Position> DoLayout(
+  virtual Positions DoLayout(
       std::vector<std::tuple<std::unique_ptr<XComponent>, int32_t>>& entries,
       gfx::Rect size) override;
 
@@ -67,7 +70,7 @@ class ScrollPanelLayout : public Layout {
 class ScrollBarTrackLayout : public Layout {
  public:
   ScrollBarTrackLayout(XScrollPanel* panel, ScrollBarTrack::Mode mode);
-  virtual std::vector<Position> DoLayout(
+  virtual Positions DoLayout(
       std::vector<std::tuple<std::unique_ptr<XComponent>, int32_t>>& entries,
       gfx::Rect size) override;
 
@@ -115,6 +118,13 @@ class XScrollPanel : public XPanel {
   virtual void AddComponent(std::unique_ptr<XComponent> component) override;
   virtual void RemoveComponent(XComponent*) override;
   virtual void RemoveAll() override;
+  virtual void ReplaceComponents(
+      size_t position,
+      size_t count,
+      std::vector<std::unique_ptr<XComponent>> components,
+      int32_t key = 0) override;
+  virtual void BeginUpdate() override;
+  virtual void EndUpdate() override;
   virtual void SetLayout(std::unique_ptr<Layout>) override;
   virtual void AddComponentListener(
       std::shared_ptr<ContainerListener>) override;
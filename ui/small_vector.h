@@ -0,0 +1,110 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <utility>
+
+namespace xpp::ui {
+
+// A vector that keeps its first |N| elements inside the object, and only
+// goes to the heap past that. Meant for per-component lists that are almost
+// always empty or tiny, like listeners.
+template <typename T, size_t N>
+class SmallVector {
+ public:
+  SmallVector() = default;
+  ~SmallVector() {
+    clear();
+    if (!is_inline())
+      std::allocator<T>().deallocate(data_, capacity_);
+  }
+
+  SmallVector(SmallVector&& other) noexcept { MoveFrom(std::move(other)); }
+  SmallVector& operator=(SmallVector&& other) noexcept {
+    if (this == &other)
+      return *this;
+    clear();
+    if (!is_inline())
+      std::allocator<T>().deallocate(data_, capacity_);
+    data_ = reinterpret_cast<T*>(inline_);
+    capacity_ = N;
+    MoveFrom(std::move(other));
+    return *this;
+  }
+
+  SmallVector(const SmallVector&) = delete;
+  SmallVector& operator=(const SmallVector&) = delete;
+
+  void push_back(const T& value) { emplace_back(value); }
+  void push_back(T&& value) { emplace_back(std::move(value)); }
+
+  template <typename... Args>
+  T& emplace_back(Args&&... args) {
+    if (size_ == capacity_)
+      return GrowAndEmplace(std::forward<Args>(args)...);
+    T* slot = new (data_ + size_) T(std::forward<Args>(args)...);
+    size_++;
+    return *slot;
+  }
+
+  void clear() {
+    std::destroy(begin(), end());
+    size_ = 0;
+  }
+
+  size_t size() const { return size_; }
+  bool empty() const { return !size_; }
+
+  T& operator[](size_t i) { return data_[i]; }
+  const T& operator[](size_t i) const { return data_[i]; }
+
+  T* begin() { return data_; }
+  T* end() { return data_ + size_; }
+  const T* begin() const { return data_; }
+  const T* end() const { return data_ + size_; }
+
+ private:
+  bool is_inline() const {
+    return data_ == reinterpret_cast<const T*>(inline_);
+  }
+
+  // The new element is made before the old ones move, since |args| may
+  // refer to one of them, as in v.push_back(v[0]).
+  template <typename... Args>
+  T& GrowAndEmplace(Args&&... args) {
+    const size_t capacity = capacity_ * 2;
+    T* data = std::allocator<T>().allocate(capacity);
+    T* slot = new (data + size_) T(std::forward<Args>(args)...);
+    std::uninitialized_move(begin(), end(), data);
+    std::destroy(begin(), end());
+    if (!is_inline())
+      std::allocator<T>().deallocate(data_, capacity_);
+    data_ = data;
+    capacity_ = capacity;
+    size_++;
+    return *slot;
+  }
+
+  void MoveFrom(SmallVector&& other) {
+    if (!other.is_inline()) {
+      // Take the heap buffer as it is.
+      data_ = std::exchange(other.data_, reinterpret_cast<T*>(other.inline_));
+      size_ = std::exchange(other.size_, 0);
+      capacity_ = std::exchange(other.capacity_, N);
+      return;
+    }
+    std::uninitialized_move(other.begin(), other.end(), data_);
+    size_ = other.size_;
+    other.clear();
+  }
+
+  static_assert(N > 0, "use std::vector for no inline capacity");
+
+  alignas(T) unsigned char inline_[N * sizeof(T)];
+  T* data_ = reinterpret_cast<T*>(inline_);
+  size_t size_ = 0;
+  size_t capacity_ = N;
+};
+
+}  // namespace xpp::ui
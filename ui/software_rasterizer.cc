@@ -0,0 +1,476 @@
+#include "software_rasterizer.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "../xlib/xpixel_converter.h"
+
+namespace xpp::ui {
+
+namespace {
+
+template <typename... Fns>
+struct Visitor : Fns... {
+  using Fns::operator()...;
+};
+
+template <typename... Fns>
+Visitor(Fns...) -> Visitor<Fns...>;
+
+// The layout tiles are drawn in, with a byte per channel for Blend().
+uint32_t ToPixel(gfx::Color color) {
+  return ((color.red() >> 8) << 16) | ((color.green() >> 8) << 8) |
+         (color.blue() >> 8);
+}
+
+uint32_t Blend(uint32_t dst, uint32_t src, uint8_t alpha) {
+  uint32_t result = 0;
+  for (int shift = 0; shift < 24; shift += 8) {
+    uint32_t d = (dst >> shift) & 0xFF;
+    uint32_t s = (src >> shift) & 0xFF;
+    result |= (((s * alpha + d * (255 - alpha)) / 255) & 0xFF) << shift;
+  }
+  return result | (dst & 0xFF000000);
+}
+
+// Writes pixels into a surface, discarding anything outside the clip box.
+class TilePainter {
+ public:
+  TilePainter(std::vector<uint32_t>* pixels,
+              uint32_t stride,
+              int64_t x0,
+              int64_t y0,
+              int64_t x1,
+              int64_t y1)
+      : pixels_(pixels), stride_(stride), x0_(x0), y0_(y0), x1_(x1), y1_(y1) {}
+
+  void Plot(int64_t x, int64_t y, uint32_t pixel) {
+    if (x < x0_ || x >= x1_ || y < y0_ || y >= y1_)
+      return;
+    (*pixels_)[y * stride_ + x] = pixel;
+  }
+
+  void Mix(int64_t x, int64_t y, uint32_t pixel, uint8_t alpha) {
+    if (!alpha || x < x0_ || x >= x1_ || y < y0_ || y >= y1_)
+      return;
+    uint32_t& dst = (*pixels_)[y * stride_ + x];
+    dst = alpha == 255 ? pixel : Blend(dst, pixel, alpha);
+  }
+
+  void Fill(int64_t x, int64_t y, int64_t w, int64_t h, uint32_t pixel) {
+    int64_t left = std::max(x, x0_);
+    int64_t right = std::min(x + w, x1_);
+    int64_t top = std::max(y, y0_);
+    int64_t bottom = std::min(y + h, y1_);
+    for (int64_t row = top; row < bottom; row++) {
+      uint32_t* line = pixels_->data() + row * stride_;
+      std::fill(line + left, line + std::max(left, right), pixel);
+    }
+  }
+
+  // Copies a |w|*|h| block of |from|, whose rows are |from_stride| apart, to
+  // (x, y). Only the rows and columns inside the clip box are touched.
+  void Copy(int64_t x,
+            int64_t y,
+            int64_t w,
+            int64_t h,
+            const uint32_t* from,
+            int64_t from_stride) {
+    int64_t left = std::max(x, x0_);
+    int64_t right = std::min(x + w, x1_);
+    int64_t top = std::max(y, y0_);
+    int64_t bottom = std::min(y + h, y1_);
+    if (left >= right)
+      return;
+    for (int64_t row = top; row < bottom; row++) {
+      const uint32_t* source = from + (row - y) * from_stride + (left - x);
+      std::copy(source, source + (right - left),
+                pixels_->data() + row * stride_ + left);
+    }
+  }
+
+  // Inclusive of both endpoints, like XDrawLine with a zero-width line.
+  void Line(int64_t x0, int64_t y0, int64_t x1, int64_t y1, uint32_t pixel) {
+    if (y0 == y1)
+      return Fill(std::min(x0, x1), y0, std::abs(x1 - x0) + 1, 1, pixel);
+    if (x0 == x1)
+      return Fill(x0, std::min(y0, y1), 1, std::abs(y1 - y0) + 1, pixel);
+
+    int64_t dx = std::abs(x1 - x0);
+    int64_t dy = -std::abs(y1 - y0);
+    int64_t sx = x0 < x1 ? 1 : -1;
+    int64_t sy = y0 < y1 ? 1 : -1;
+    int64_t error = dx + dy;
+    while (true) {
+      Plot(x0, y0, pixel);
+      if (x0 == x1 && y0 == y1)
+        return;
+      int64_t e2 = 2 * error;
+      if (e2 >= dy) {
+        error += dy;
+        x0 += sx;
+      }
+      if (e2 <= dx) {
+        error += dx;
+        y0 += sy;
+      }
+    }
+  }
+
+  // One quarter of the circle inscribed in the |r|*2 box at (bx, by). |sx|
+  // and |sy| pick the quarter: -1 for left/top, 1 for right/bottom.
+  void Quadrant(int64_t bx,
+                int64_t by,
+                int64_t r,
+                int sx,
+                int sy,
+                bool filled,
+                uint32_t pixel) {
+    double cx = bx + r;
+    double cy = by + r;
+    int64_t left = sx < 0 ? bx : bx + r;
+    int64_t top = sy < 0 ? by : by + r;
+    for (int64_t y = std::max(top, y0_); y <= std::min(top + r, y1_ - 1); y++) {
+      for (int64_t x = std::max(left, x0_); x <= std::min(left + r, x1_ - 1);
+           x++) {
+        double d = std::hypot(x + 0.5 - cx, y + 0.5 - cy);
+        if (filled ? d < r : std::abs(d - r) < 0.5)
+          (*pixels_)[y * stride_ + x] = pixel;
+      }
+    }
+  }
+
+ private:
+  std::vector<uint32_t>* pixels_;
+  uint32_t stride_;
+  int64_t x0_;
+  int64_t y0_;
+  int64_t x1_;
+  int64_t y1_;
+};
+
+}  // namespace
+
+SoftwareRasterizer::SoftwareRasterizer(std::shared_ptr<xlib::XDisplay> display,
+                                       const Visual* visual,
+                                       size_t threads,
+                                       uint32_t tile_size)
+    : display_(std::move(display)),
+      pool_(threads ? threads - 1 : 0),
+      tile_size_(std::max<uint32_t>(tile_size, 16)) {
+  const xlib::XPixelConverter converter(visual);
+  if (!converter.IsDirect())
+    return;
+  for (uint32_t i = 0; i < 256; i++) {
+    const uint16_t value = i * 257;
+    red_[i] = converter.Convert(value, 0, 0);
+    green_[i] = converter.Convert(0, value, 0);
+    blue_[i] = converter.Convert(0, 0, value);
+  }
+  convert_ = red_[255] != 0xFF0000 || green_[255] != 0xFF00 ||
+             blue_[255] != 0xFF;
+}
+
+SoftwareRasterizer::~SoftwareRasterizer() = default;
+
+const std::vector<uint32_t>& SoftwareRasterizer::Rasterize(
+    const DisplayList& list,
+    gfx::Rect size) {
+  // Drop glyphs of fonts that have been closed since the last frame, before
+  // their addresses can turn up again for different fonts.
+  for (auto itr = fonts_.begin(); itr != fonts_.end();) {
+    if (!itr->second.expired()) {
+      ++itr;
+      continue;
+    }
+    glyphs_.erase(glyphs_.lower_bound({itr->first, 0}),
+                  glyphs_.lower_bound({itr->first + 1, 0}));
+    itr = fonts_.erase(itr);
+  }
+
+  frame_.size = size;
+  RasterizeInto(list, &frame_);
+  layers_.clear();
+  ConvertToVisual(&frame_.pixels);
+  return frame_.pixels;
+}
+
+void SoftwareRasterizer::ConvertToVisual(std::vector<uint32_t>* pixels) const {
+  if (!convert_)
+    return;
+  for (uint32_t& pixel : *pixels) {
+    pixel = red_[(pixel >> 16) & 0xFF] | green_[(pixel >> 8) & 0xFF] |
+            blue_[pixel & 0xFF];
+  }
+}
+
+void SoftwareRasterizer::RasterizeInto(const DisplayList& list,
+                                       Surface* surface) {
+  surface->pixels.assign(
+      static_cast<size_t>(surface->size.width) * surface->size.height, 0);
+
+  // Resolve color and font state up front so that every tile can start at
+  // any op, and rasterize nested layers before anything samples them.
+  std::vector<Command> commands;
+  uint32_t pixel = 0;
+  XftFont* font = nullptr;
+  for (const auto& op : list.GetOps()) {
+    Command command = {&op, pixel, font, {0, 0, 0, 0}, {}};
+    std::visit(
+        Visitor{
+            [&](const ops::SetColor& op) { pixel = ToPixel(op.color); },
+            [&](const ops::SetFont& op) {
+              font = op.font.xft_font_.get();
+              // The display list holds the font open while this frame is
+              // drawn; remember it so its glyphs can be dropped after it
+              // closes.
+              if (font)
+                fonts_[font] = op.font.xft_font_;
+            },
+            [&](const ops::FillRect& op) {
+              command.bounds = {op.at.x, op.at.y, op.at.x + op.size.width,
+                                op.at.y + op.size.height};
+            },
+            [&](const ops::DrawRect& op) {
+              command.bounds = {op.at.x, op.at.y, op.at.x + op.size.width + 1,
+                                op.at.y + op.size.height + 1};
+            },
+            [&](const ops::FillRoundedRect& op) {
+              command.bounds = {op.at.x, op.at.y, op.at.x + op.size.width + 1,
+                                op.at.y + op.size.height + 1};
+            },
+            [&](const ops::DrawRoundedRect& op) {
+              command.bounds = {op.at.x, op.at.y, op.at.x + op.size.width + 1,
+                                op.at.y + op.size.height + 1};
+            },
+            [&](const ops::FillGradient& op) {
+              command.bounds = {op.at.x, op.at.y, op.at.x + op.size.width,
+                                op.at.y + op.size.height};
+              command.pixels.resize(static_cast<size_t>(op.size.width) *
+                                    op.size.height);
+              ForEachGradientBand(
+                  op.gradient, op.size,
+                  [&](gfx::Color color,
+                      const std::vector<GradientSpan>& spans) {
+                    uint32_t pixel = ToPixel(color);
+                    for (const GradientSpan& span : spans) {
+                      for (int64_t y = span.y; y < span.y + span.height; y++) {
+                        auto row = command.pixels.begin() +
+                                   y * op.size.width + span.x;
+                        std::fill(row, row + span.width, pixel);
+                      }
+                    }
+                  });
+            },
+            [&](const ops::DrawText& op) {
+              if (!font)
+                return;
+              command.glyphs = ShapeText(font, op.message);
+              int64_t width = 0;
+              for (const Glyph* glyph : command.glyphs)
+                width += glyph->advance;
+              int64_t baseline = op.at.y + font->ascent;
+              command.bounds = {op.at.x - font->max_advance_width,
+                                baseline - font->ascent - font->height,
+                                op.at.x + width + font->max_advance_width,
+                                baseline + font->descent + font->height};
+            },
+            [&](const ops::Layer& op) {
+              Surface& layer = layers_[&op];
+              layer.size = op.layer_size;
+              RasterizeInto(*op.list, &layer);
+              command.bounds = {op.dest.x, op.dest.y,
+                                op.dest.x + op.dest_size.width,
+                                op.dest.y + op.dest_size.height};
+            },
+        },
+        op);
+    if (command.bounds.x1 > command.bounds.x0 &&
+        command.bounds.y1 > command.bounds.y0) {
+      commands.push_back(std::move(command));
+    }
+  }
+
+  const uint32_t columns = (surface->size.width + tile_size_ - 1) / tile_size_;
+  const uint32_t rows = (surface->size.height + tile_size_ - 1) / tile_size_;
+  std::vector<std::vector<uint32_t>> bins(columns * rows);
+  for (uint32_t i = 0; i < commands.size(); i++) {
+    const Bounds& b = commands[i].bounds;
+    int64_t first_column = std::max<int64_t>(b.x0, 0) / tile_size_;
+    int64_t last_column =
+        std::min<int64_t>((b.x1 - 1) / tile_size_, int64_t{columns} - 1);
+    int64_t first_row = std::max<int64_t>(b.y0, 0) / tile_size_;
+    int64_t last_row =
+        std::min<int64_t>((b.y1 - 1) / tile_size_, int64_t{rows} - 1);
+    for (int64_t row = first_row; row <= last_row; row++) {
+      for (int64_t column = first_column; column <= last_column; column++)
+        bins[row * columns + column].push_back(i);
+    }
+  }
+
+  pool_.ParallelFor(bins.size(), [&](size_t tile) {
+    if (bins[tile].empty())
+      return;
+    int64_t x0 = (tile % columns) * tile_size_;
+    int64_t y0 = (tile / columns) * tile_size_;
+    Bounds clip = {x0, y0,
+                   std::min<int64_t>(x0 + tile_size_, surface->size.width),
+                   std::min<int64_t>(y0 + tile_size_, surface->size.height)};
+    RasterizeTile(commands.data(), bins[tile], clip, surface);
+  });
+}
+
+void SoftwareRasterizer::RasterizeTile(const Command* commands,
+                                       const std::vector<uint32_t>& bin,
+                                       Bounds clip,
+                                       Surface* surface) {
+  TilePainter painter(&surface->pixels, surface->size.width, clip.x0, clip.y0,
+                      clip.x1, clip.y1);
+  for (uint32_t i : bin) {
+    const Command& command = commands[i];
+    const uint32_t pixel = command.pixel;
+    std::visit(
+        Visitor{
+            [&](const ops::FillRect& op) {
+              painter.Fill(op.at.x, op.at.y, op.size.width, op.size.height,
+                           pixel);
+            },
+            [&](const ops::DrawRect& op) {
+              int64_t x = op.at.x;
+              int64_t y = op.at.y;
+              int64_t w = op.size.width;
+              int64_t h = op.size.height;
+              painter.Line(x, y, x + w, y, pixel);
+              painter.Line(x, y + h, x + w, y + h, pixel);
+              painter.Line(x, y, x, y + h, pixel);
+              painter.Line(x + w, y, x + w, y + h, pixel);
+            },
+            [&](const ops::FillRoundedRect& op) {
+              // Same decomposition as Graphics::FillRoundedRect.
+              int64_t x = op.at.x;
+              int64_t y = op.at.y;
+              int64_t w = op.size.width;
+              int64_t h = op.size.height;
+              int64_t r = op.radius;
+              painter.Fill(x + r, y, w - r * 2, h, pixel);
+              painter.Fill(x, y + r, w, h - r * 2, pixel);
+              painter.Quadrant(x, y, r, -1, -1, true, pixel);
+              painter.Quadrant(x + w - r * 2, y, r, 1, -1, true, pixel);
+              painter.Quadrant(x + w - r * 2, y + h - r * 2 - 1, r, 1, 1, true,
+                               pixel);
+              painter.Quadrant(x, y + h - r * 2 - 1, r, -1, 1, true, pixel);
+            },
+            [&](const ops::DrawRoundedRect& op) {
+              // Same decomposition as Graphics::DrawRoundedRect.
+              int64_t x = op.at.x;
+              int64_t y = op.at.y;
+              int64_t w = op.size.width;
+              int64_t h = op.size.height;
+              int64_t r = op.radius;
+              painter.Line(x + r, y, x + w - r, y, pixel);
+              painter.Line(x + r, y + h - 1, x + w - r, y + h - 1, pixel);
+              painter.Line(x + w, y + r, x + w, y + h - r, pixel);
+              painter.Line(x, y + r, x, y + h - r, pixel);
+              painter.Quadrant(x, y, r, -1, -1, false, pixel);
+              painter.Quadrant(x + w - r * 2, y, r, 1, -1, false, pixel);
+              painter.Quadrant(x + w - r * 2, y + h - r * 2 - 1, r, 1, 1,
+                               false, pixel);
+              painter.Quadrant(x, y + h - r * 2 - 1, r, -1, 1, false, pixel);
+            },
+            [&](const ops::FillGradient& op) {
+              painter.Copy(op.at.x, op.at.y, op.size.width, op.size.height,
+                           command.pixels.data(), op.size.width);
+            },
+            [&](const ops::DrawText& op) {
+              int64_t pen = op.at.x;
+              int64_t baseline = op.at.y + command.font->ascent;
+              for (const Glyph* glyph : command.glyphs) {
+                for (uint32_t gy = 0; gy < glyph->height; gy++) {
+                  for (uint32_t gx = 0; gx < glyph->width; gx++) {
+                    painter.Mix(pen + glyph->left + gx,
+                                baseline - glyph->top + gy, pixel,
+                                glyph->coverage[gy * glyph->width + gx]);
+                  }
+                }
+                pen += glyph->advance;
+              }
+            },
+            [&](const ops::Layer& op) {
+              const Surface& layer = layers_.at(&op);
+              int64_t w = std::min<int64_t>(op.dest_size.width,
+                                            layer.size.width - op.source.x);
+              int64_t h = std::min<int64_t>(op.dest_size.height,
+                                            layer.size.height - op.source.y);
+              if (w <= 0 || h <= 0)
+                return;
+              painter.Copy(op.dest.x, op.dest.y, w, h,
+                           layer.pixels.data() +
+                               op.source.y * layer.size.width + op.source.x,
+                           layer.size.width);
+            },
+            [](const auto&) {},
+        },
+        *command.op);
+  }
+}
+
+std::vector<const SoftwareRasterizer::Glyph*> SoftwareRasterizer::ShapeText(
+    XftFont* font,
+    const std::string& text) {
+  std::vector<const Glyph*> result;
+  const FcChar8* data = reinterpret_cast<const FcChar8*>(text.data());
+  int remaining = text.length();
+  while (remaining > 0) {
+    FcChar32 ucs4;
+    int consumed = FcUtf8ToUcs4(data, &ucs4, remaining);
+    if (consumed <= 0)
+      break;
+    data += consumed;
+    remaining -= consumed;
+    if (const Glyph* glyph =
+            GetGlyph(font, display_->XftCharIndex(font, ucs4))) {
+      result.push_back(glyph);
+    }
+  }
+  return result;
+}
+
+const SoftwareRasterizer::Glyph* SoftwareRasterizer::GetGlyph(XftFont* font,
+                                                              FT_UInt index) {
+  auto& slot = glyphs_[{font, index}];
+  if (slot)
+    return slot.get();
+
+  FT_Face face = XftLockFace(font);
+  if (!face)
+    return nullptr;
+
+  if (FT_Load_Glyph(face, index, FT_LOAD_RENDER)) {
+    XftUnlockFace(font);
+    return nullptr;
+  }
+
+  const FT_GlyphSlot rendered = face->glyph;
+  const FT_Bitmap& bitmap = rendered->bitmap;
+  slot = std::make_unique<Glyph>();
+  slot->left = rendered->bitmap_left;
+  slot->top = rendered->bitmap_top;
+  slot->width = bitmap.width;
+  slot->height = bitmap.rows;
+  slot->advance = rendered->advance.x >> 6;
+  slot->coverage.resize(bitmap.width * bitmap.rows);
+  for (uint32_t y = 0; y < bitmap.rows; y++) {
+    const uint8_t* row = bitmap.buffer + y * bitmap.pitch;
+    for (uint32_t x = 0; x < bitmap.width; x++) {
+      uint8_t value = bitmap.pixel_mode == FT_PIXEL_MODE_MONO
+                          ? ((row[x / 8] >> (7 - x % 8)) & 1) * 255
+                          : row[x];
+      slot->coverage[y * bitmap.width + x] = value;
+    }
+  }
+
+  XftUnlockFace(font);
+  return slot.get();
+}
+
+}  // namespace xpp::ui
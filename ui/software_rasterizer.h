@@ -0,0 +1,99 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <vector>
+
+#include "../gfx/rect.h"
+#include "../xlib/xdisplay.h"
+#include "display_list.h"
+#include "thread_pool.h"
+
+namespace xpp::ui {
+
+// Rasterizes a DisplayList into a client-side 32 bit pixel buffer. The frame
+// is cut into square tiles, every draw op is binned into the tiles its bounds
+// touch, and the tiles are filled in parallel on a WorkStealingPool. Text is
+// rendered through the Xft font's FreeType face; core X fonts are skipped.
+//
+// Tiles are drawn as 0x00RRGGBB and the finished frame is converted to
+// |visual|'s channel layout, so it can be uploaded as is.
+class SoftwareRasterizer {
+ public:
+  SoftwareRasterizer(std::shared_ptr<xlib::XDisplay> display,
+                     const Visual* visual,
+                     size_t threads,
+                     uint32_t tile_size = 128);
+  ~SoftwareRasterizer();
+
+  // The returned buffer is |size.width| pixels per row and stays valid until
+  // the next call.
+  const std::vector<uint32_t>& Rasterize(const DisplayList& list,
+                                         gfx::Rect size);
+
+ private:
+  struct Glyph {
+    int32_t left;
+    int32_t top;
+    uint32_t width;
+    uint32_t height;
+    int32_t advance;
+    std::vector<uint8_t> coverage;
+  };
+
+  struct Surface {
+    gfx::Rect size = {0, 0};
+    std::vector<uint32_t> pixels;
+  };
+
+  struct Bounds {
+    int64_t x0;
+    int64_t y0;
+    int64_t x1;
+    int64_t y1;
+  };
+
+  // A draw op with the color and font that were current when it was recorded.
+  struct Command {
+    const DisplayList::Op* op;
+    uint32_t pixel;
+    XftFont* font;
+    Bounds bounds;
+    std::vector<const Glyph*> glyphs;
+    // FillGradient ops are resolved into a block of pixels up front.
+    std::vector<uint32_t> pixels;
+  };
+
+  void RasterizeInto(const DisplayList& list, Surface* surface);
+  void RasterizeTile(const Command* commands,
+                     const std::vector<uint32_t>& bin,
+                     Bounds clip,
+                     Surface* surface);
+  std::vector<const Glyph*> ShapeText(XftFont* font, const std::string& text);
+  const Glyph* GetGlyph(XftFont* font, FT_UInt index);
+
+  // Rewrites |pixels| from 0x00RRGGBB into the visual's layout.
+  void ConvertToVisual(std::vector<uint32_t>* pixels) const;
+
+  std::shared_ptr<xlib::XDisplay> display_;
+  // Each 8 bit channel value placed where the visual wants it, built with
+  // its XPixelConverter. Unused when the visual is 0x00RRGGBB already, or has
+  // no fixed mapping.
+  std::array<uint32_t, 256> red_ = {};
+  std::array<uint32_t, 256> green_ = {};
+  std::array<uint32_t, 256> blue_ = {};
+  bool convert_ = false;
+  WorkStealingPool pool_;
+  uint32_t tile_size_;
+
+  Surface frame_;
+  std::map<const ops::Layer*, Surface> layers_;
+  // Glyphs are cached by font address. Fonts aren't kept open for that; once
+  // one has expired its glyphs are dropped, since the address may be reused.
+  std::map<XftFont*, std::weak_ptr<XftFont>> fonts_;
+  std::map<std::pair<XftFont*, FT_UInt>, std::unique_ptr<Glyph>> glyphs_;
+};
+
+}  // namespace xpp::ui
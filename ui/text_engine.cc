@@ -0,0 +1,156 @@
+#include "text_engine.h"
+
+#include <algorithm>
+#include <climits>
+
+namespace xpp::ui {
+
+TextEngine::TextEngine() = default;
+
+TextEngine::~TextEngine() = default;
+
+gfx::Rect TextEngine::Measure(xlib::XGraphics* gc,
+                              const gfx::Font& font,
+                              std::string_view text) {
+  switch (font.mode_) {
+    case gfx::Font::TextRenderingMode::kXorg: {
+      // Core font metrics live client side already.
+      int width = XTextWidth(font.xfont_, text.data(), text.length());
+      return {static_cast<uint32_t>(std::max(width, 0)),
+              static_cast<uint32_t>(font.xfont_->ascent +
+                                    font.xfont_->descent)};
+    }
+    case gfx::Font::TextRenderingMode::kXFT: {
+      std::lock_guard<std::mutex> hold(lock_);
+      const Run& run = Shape(gc, font, text);
+      return {static_cast<uint32_t>(std::max<int>(run.extents.xOff, 0)),
+              static_cast<uint32_t>(font.xft_font_->height)};
+    }
+    default:
+      return {0, 0};
+  }
+}
+
+void TextEngine::MeasurePrefixes(xlib::XGraphics* gc,
+                                 const gfx::Font& font,
+                                 std::string_view text,
+                                 std::vector<uint32_t>* widths) {
+  widths->assign(text.length() + 1, 0);
+  switch (font.mode_) {
+    case gfx::Font::TextRenderingMode::kXorg: {
+      // Core fonts are one byte per character.
+      uint32_t pen = 0;
+      for (size_t i = 0; i < text.length(); i++) {
+        pen += std::max(XTextWidth(font.xfont_, text.data() + i, 1), 0);
+        (*widths)[i + 1] = pen;
+      }
+      return;
+    }
+    case gfx::Font::TextRenderingMode::kXFT: {
+      std::lock_guard<std::mutex> hold(lock_);
+      XftFont* xft_font = font.xft_font_.get();
+      const FcChar8* data = reinterpret_cast<const FcChar8*>(text.data());
+      size_t offset = 0;
+      uint32_t pen = 0;
+      while (offset < text.length()) {
+        FcChar32 ucs4;
+        int consumed =
+            FcUtf8ToUcs4(data + offset, &ucs4, text.length() - offset);
+        if (consumed <= 0)
+          break;
+        for (int i = 1; i < consumed; i++)
+          (*widths)[offset + i] = pen;
+        offset += consumed;
+
+        FT_UInt glyph = gc->XftCharIndex(xft_font, ucs4);
+        XGlyphInfo info;
+        gc->XftGlyphExtents(xft_font, &glyph, 1, &info);
+        pen = std::max<int64_t>(pen + info.xOff, 0);
+        (*widths)[offset] = pen;
+      }
+      // Whatever is past invalid UTF-8 doesn't draw.
+      for (size_t i = offset + 1; i <= text.length(); i++)
+        (*widths)[i] = pen;
+      return;
+    }
+    default:
+      return;
+  }
+}
+
+void TextEngine::Draw(xlib::XGraphics* gc,
+                      XftDraw* draw,
+                      const XftColor* color,
+                      const gfx::Font& font,
+                      int x,
+                      int y,
+                      std::string_view text) {
+  std::lock_guard<std::mutex> hold(lock_);
+  // XftGlyphSpec positions are shorts, like every coordinate X takes, so
+  // glyphs that land outside them can't be drawn and are skipped rather
+  // than left to wrap around onto the drawable.
+  if (y < SHRT_MIN || y > SHRT_MAX)
+    return;
+  const Run& run = Shape(gc, font, text);
+  scratch_.clear();
+  for (const Glyph& glyph : run.glyphs) {
+    const int64_t pen = int64_t{x} + glyph.x;
+    if (pen < SHRT_MIN || pen > SHRT_MAX)
+      continue;
+    scratch_.push_back(
+        {glyph.index, static_cast<short>(pen), static_cast<short>(y)});
+  }
+  gc->XftDrawGlyphSpec(draw, color, font.xft_font_.get(), scratch_.data(),
+                       scratch_.size());
+}
+
+const TextEngine::Run& TextEngine::Shape(xlib::XGraphics* gc,
+                                         const gfx::Font& font,
+                                         std::string_view text) {
+  XftFont* xft_font = font.xft_font_.get();
+  auto found = fonts_.find(xft_font);
+  if (found == fonts_.end()) {
+    // Forget fonts nobody holds any more before adding another.
+    std::erase_if(fonts_,
+                  [](const auto& entry) { return entry.second.font.expired(); });
+    found = fonts_.emplace(xft_font, FontRuns{}).first;
+  }
+  FontRuns& cache = found->second;
+  if (cache.font.expired()) {
+    cache.runs.clear();
+    cache.font = font.xft_font_;
+  }
+
+  auto itr = cache.runs.find(text);
+  if (itr != cache.runs.end())
+    return itr->second;
+
+  if (cache.runs.size() >= kMaxRunsPerFont)
+    cache.runs.clear();
+
+  Run run;
+  const FcChar8* data = reinterpret_cast<const FcChar8*>(text.data());
+  int remaining = text.length();
+  int32_t pen = 0;
+  while (remaining > 0) {
+    FcChar32 ucs4;
+    int consumed = FcUtf8ToUcs4(data, &ucs4, remaining);
+    if (consumed <= 0)
+      break;
+    data += consumed;
+    remaining -= consumed;
+
+    FT_UInt glyph = gc->XftCharIndex(xft_font, ucs4);
+    XGlyphInfo info;
+    gc->XftGlyphExtents(xft_font, &glyph, 1, &info);
+    run.glyphs.push_back({glyph, pen});
+    pen += info.xOff;
+  }
+
+  gc->XftTextExtentsUtf8(xft_font,
+                         reinterpret_cast<const FcChar8*>(text.data()),
+                         text.length(), &run.extents);
+  return cache.runs.emplace(std::string(text), std::move(run)).first->second;
+}
+
+}  // namespace xpp::ui
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "../gfx/rect.h"
+#include "../xlib/xgraphics.h"
+#include "font.h"
+
+namespace xpp::ui {
+
+// Remembers, per font and string, the glyph indices and pen positions Xft
+// works out for a piece of text along with its extents. Laying out or
+// drawing a label that has been seen before is one hash lookup.
+class TextEngine {
+ public:
+  TextEngine();
+  ~TextEngine();
+
+  // The advance width of |text| and the font's line height.
+  gfx::Rect Measure(xlib::XGraphics* gc,
+                    const gfx::Font& font,
+                    std::string_view text);
+
+  // Fills |widths| with the pen position after every prefix of |text|:
+  // (*widths)[i] is the advance of its first i bytes, and a byte inside a
+  // character carries the position its character starts at. Nothing is
+  // cached, so layout can search within a paragraph at no more cost than
+  // one pass over its characters.
+  void MeasurePrefixes(xlib::XGraphics* gc,
+                       const gfx::Font& font,
+                       std::string_view text,
+                       std::vector<uint32_t>* widths);
+
+  // Draws |text| with its baseline at |y| through XftDrawGlyphSpec.
+  void Draw(xlib::XGraphics* gc,
+            XftDraw* draw,
+            const XftColor* color,
+            const gfx::Font& font,
+            int x,
+            int y,
+            std::string_view text);
+
+ private:
+  struct Glyph {
+    FT_UInt index;
+    // Pen position relative to the start of the baseline. Kept wider than
+    // XftGlyphSpec's shorts so that long runs don't wrap.
+    int32_t x;
+  };
+
+  struct Run {
+    std::vector<Glyph> glyphs;
+    XGlyphInfo extents;
+  };
+
+  // Lets |runs| be searched with a string_view.
+  struct TextHash {
+    using is_transparent = void;
+    size_t operator()(std::string_view text) const {
+      return std::hash<std::string_view>()(text);
+    }
+  };
+
+  struct FontRuns {
+    // Doesn't pin the font, so it can still go idle and be evicted from the
+    // XFontCache. Once it has expired, the address may belong to a different
+    // font and the runs are thrown away.
+    std::weak_ptr<XftFont> font;
+    std::unordered_map<std::string, Run, TextHash, std::equal_to<>> runs;
+  };
+
+  // Expects |lock_| to be held.
+  const Run& Shape(xlib::XGraphics* gc,
+                   const gfx::Font& font,
+                   std::string_view text);
+
+  // Labels come and go with scrolled content, so a font's runs are dropped
+  // wholesale once there are this many of them.
+  static constexpr size_t kMaxRunsPerFont = 4096;
+
+  // Both the painting and the render thread draw text.
+  std::mutex lock_;
+  std::unordered_map<XftFont*, FontRuns> fonts_;
+  std::vector<XftGlyphSpec> scratch_;
+};
+
+}  // namespace xpp::ui
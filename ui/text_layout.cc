@@ -0,0 +1,224 @@
+#include "text_layout.h"
+
+#include <algorithm>
+
+#include "graphics.h"
+
+namespace xpp::ui {
+
+namespace {
+
+constexpr std::string_view kEllipsis = "…";
+
+bool IsContinuationByte(char c) {
+  return (static_cast<unsigned char>(c) & 0xC0) == 0x80;
+}
+
+}  // namespace
+
+TextLayout::TextLayout(Overflow overflow) : overflow_(overflow) {}
+
+void TextLayout::SetText(std::string_view text) {
+  paragraphs_.clear();
+  paragraphs_.emplace_back();
+  Append(text);
+}
+
+void TextLayout::Append(std::string_view text) {
+  if (paragraphs_.empty())
+    paragraphs_.emplace_back();
+
+  while (true) {
+    size_t newline = text.find('\n');
+    Paragraph& last = paragraphs_.back();
+    last.text.append(text.substr(0, newline));
+    last.measured = false;
+    last.laid_out = false;
+    if (newline == std::string_view::npos)
+      break;
+    paragraphs_.emplace_back();
+    text.remove_prefix(newline + 1);
+  }
+  dirty_ = true;
+}
+
+void TextLayout::SetWidth(uint32_t width) {
+  if (width == width_)
+    return;
+
+  // A paragraph that was a single line at both widths breaks the same way.
+  const uint32_t narrowest = std::min(width, width_);
+  for (Paragraph& paragraph : paragraphs_) {
+    if (!paragraph.measured || paragraph.natural_width > narrowest)
+      paragraph.laid_out = false;
+  }
+  width_ = width;
+  dirty_ = true;
+}
+
+uint32_t TextLayout::GetHeight(Graphics* g) {
+  Layout(g);
+  return line_count_ * line_height_;
+}
+
+size_t TextLayout::GetLineCount(Graphics* g) {
+  Layout(g);
+  return line_count_;
+}
+
+void TextLayout::Draw(Graphics* g, gfx::Coord at) {
+  const int64_t height = g->GetDimensions().height;
+  const int64_t top = std::max<int64_t>(-at.y, 0);
+  Draw(g, at, top, std::max<int64_t>(height - at.y - top, 0));
+}
+
+void TextLayout::Draw(Graphics* g,
+                      gfx::Coord at,
+                      uint32_t visible_top,
+                      uint32_t visible_height) {
+  Layout(g);
+  if (!line_height_ || !line_count_)
+    return;
+
+  const size_t first = visible_top / line_height_;
+  const size_t last = std::min<size_t>(
+      (visible_top + visible_height + line_height_ - 1) / line_height_,
+      line_count_);
+  if (first >= last)
+    return;
+
+  // The paragraph holding |first|.
+  size_t index =
+      std::upper_bound(first_line_.begin(), first_line_.end(), first) -
+      first_line_.begin() - 1;
+  for (size_t line = first; line < last; index++) {
+    const Paragraph& paragraph = paragraphs_[index];
+    for (size_t i = line - first_line_[index];
+         i < paragraph.lines.size() && line < last; i++, line++) {
+      const Line& span = paragraph.lines[i];
+      std::string_view text =
+          std::string_view(paragraph.text).substr(span.begin, span.length);
+      const gfx::Coord pen = {at.x,
+                              at.y + static_cast<int64_t>(line * line_height_)};
+      if (span.ellipsis)
+        g->DrawText(pen, std::string(text).append(kEllipsis));
+      else
+        g->DrawText(pen, text);
+    }
+  }
+}
+
+void TextLayout::Layout(Graphics* g) {
+  if (!(g->GetFont() == font_)) {
+    font_ = g->GetFont();
+    line_height_ = g->MeasureText("").height;
+    for (Paragraph& paragraph : paragraphs_) {
+      paragraph.measured = false;
+      paragraph.laid_out = false;
+    }
+    dirty_ = true;
+  }
+
+  if (!dirty_)
+    return;
+
+  first_line_.resize(paragraphs_.size());
+  line_count_ = 0;
+  for (size_t i = 0; i < paragraphs_.size(); i++) {
+    Paragraph& paragraph = paragraphs_[i];
+    if (!paragraph.laid_out)
+      Break(g, &paragraph);
+    first_line_[i] = line_count_;
+    line_count_ += paragraph.lines.size();
+  }
+  dirty_ = false;
+}
+
+void TextLayout::Break(Graphics* g, Paragraph* paragraph) {
+  paragraph->lines.clear();
+  paragraph->laid_out = true;
+  const bool fits = paragraph->natural_width <= width_ || !width_;
+  if (!paragraph->measured || !fits) {
+    g->MeasurePrefixes(paragraph->text, &widths_);
+    paragraph->natural_width = widths_.back();
+    paragraph->measured = true;
+  }
+
+  if (paragraph->natural_width <= width_ || !width_) {
+    paragraph->lines.push_back({0, paragraph->text.length(), false});
+    return;
+  }
+
+  if (overflow_ == Overflow::kEllipsis)
+    Ellipsize(g, paragraph);
+  else
+    Wrap(paragraph);
+}
+
+void TextLayout::Wrap(Paragraph* paragraph) {
+  const std::string& text = paragraph->text;
+  // Spans are measured from the prefix widths, spaces and all.
+  auto width = [this](size_t begin, size_t end) {
+    return widths_[end] - widths_[begin];
+  };
+
+  size_t line_begin = 0;
+  size_t line_end = 0;
+  size_t word_begin = 0;
+  while (word_begin < text.length()) {
+    size_t word_end = text.find(' ', word_begin);
+    if (word_end == std::string::npos)
+      word_end = text.length();
+
+    const bool first_word = line_end == line_begin;
+    if (width(line_begin, word_end) <= width_) {
+      line_end = word_end;
+    } else if (!first_word) {
+      // Start the word over on a line of its own.
+      paragraph->lines.push_back({line_begin, line_end - line_begin, false});
+      line_begin = line_end = word_begin;
+      continue;
+    } else {
+      // Too long for any line; split it wherever it stops fitting.
+      size_t cut = FitPrefix(text, word_begin, word_end, width_);
+      // Always make progress, even if a single character doesn't fit.
+      if (cut == word_begin) {
+        cut++;
+        while (cut < word_end && IsContinuationByte(text[cut]))
+          cut++;
+      }
+      paragraph->lines.push_back({word_begin, cut - word_begin, false});
+      line_begin = line_end = word_begin = cut;
+      continue;
+    }
+    word_begin = word_end + 1;
+  }
+  if (line_end > line_begin || paragraph->lines.empty())
+    paragraph->lines.push_back({line_begin, line_end - line_begin, false});
+}
+
+void TextLayout::Ellipsize(Graphics* g, Paragraph* paragraph) {
+  const uint32_t ellipsis = g->MeasureText(kEllipsis).width;
+  size_t cut = ellipsis < width_ ? FitPrefix(paragraph->text, 0,
+                                             paragraph->text.length(),
+                                             width_ - ellipsis)
+                                 : 0;
+  paragraph->lines.push_back({0, cut, true});
+}
+
+size_t TextLayout::FitPrefix(const std::string& text,
+                             size_t begin,
+                             size_t end,
+                             uint32_t width) const {
+  // Prefix widths never shrink, so the first one past |width| is found by
+  // binary search, then snapped back to the character it falls in.
+  const uint64_t limit = uint64_t{widths_[begin]} + width;
+  size_t cut = std::upper_bound(widths_.begin() + begin,
+                                widths_.begin() + end + 1, limit) -
+               widths_.begin() - 1;
+  while (cut > begin && IsContinuationByte(text[cut]))
+    cut--;
+  return cut;
+}
+
+}  // namespace xpp::ui
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "../gfx/coord.h"
+#include "font.h"
+
+namespace xpp::ui {
+
+class Graphics;
+
+// Breaks text into lines that fit a width, one paragraph per '\n'. Every
+// paragraph keeps its own lines, so changing the width only re-breaks the
+// paragraphs that don't fit both the old and the new width, and appending
+// only touches the last paragraph and the new ones. Drawing skips every
+// line outside the visible range.
+class TextLayout {
+ public:
+  enum class Overflow {
+    kWrap,      // Break between words, or inside a word too long for a line.
+    kEllipsis,  // One line per paragraph, cut short with an ellipsis.
+  };
+
+  explicit TextLayout(Overflow overflow = Overflow::kWrap);
+
+  void SetText(std::string_view text);
+  void Append(std::string_view text);
+  void SetWidth(uint32_t width);
+
+  // Both lay out anything stale in |g|'s current font first.
+  uint32_t GetHeight(Graphics* g);
+  size_t GetLineCount(Graphics* g);
+
+  // Draws the lines that fall within |visible_height| pixels starting
+  // |visible_top| pixels below |at|.
+  void Draw(Graphics* g,
+            gfx::Coord at,
+            uint32_t visible_top,
+            uint32_t visible_height);
+
+  // Same, with the visible range being whatever of |g| the text covers.
+  void Draw(Graphics* g, gfx::Coord at);
+
+ private:
+  struct Line {
+    size_t begin;
+    size_t length;
+    bool ellipsis;
+  };
+
+  struct Paragraph {
+    std::string text;
+    // Unwrapped width, and whether it (and |lines|) are up to date.
+    uint32_t natural_width = 0;
+    bool measured = false;
+    bool laid_out = false;
+    std::vector<Line> lines;
+  };
+
+  void Layout(Graphics* g);
+  void Break(Graphics* g, Paragraph* paragraph);
+  void Wrap(Paragraph* paragraph);
+  void Ellipsize(Graphics* g, Paragraph* paragraph);
+
+  // The longest span of |text| starting at |begin| that fits |width|, cut
+  // on a UTF-8 character boundary. Reads the widths from |widths_|.
+  size_t FitPrefix(const std::string& text,
+                   size_t begin,
+                   size_t end,
+                   uint32_t width) const;
+
+  Overflow overflow_;
+  uint32_t width_ = 0;
+  gfx::Font font_;
+  uint32_t line_height_ = 0;
+
+  std::vector<Paragraph> paragraphs_;
+  // The first line of every paragraph, counted from the top.
+  std::vector<size_t> first_line_;
+  size_t line_count_ = 0;
+  bool dirty_ = false;
+
+  // The width of every prefix of the paragraph being broken, measured in
+  // one pass. Kept between paragraphs for its storage.
+  std::vector<uint32_t> widths_;
+};
+
+}  // namespace xpp::ui
@@ -0,0 +1,102 @@
+#include "thread_pool.h"
+
+#include <optional>
+
+namespace xpp::ui {
+
+WorkStealingPool::WorkStealingPool(size_t threads) {
+  // The last queue belongs to whichever thread calls ParallelFor.
+  for (size_t i = 0; i <= threads; i++)
+    queues_.push_back(std::make_unique<Queue>());
+  for (size_t i = 0; i < threads; i++)
+    threads_.emplace_back(&WorkStealingPool::Work, this, i);
+}
+
+WorkStealingPool::~WorkStealingPool() {
+  {
+    std::lock_guard<std::mutex> hold(lock_);
+    stopping_ = true;
+  }
+  wake_.notify_all();
+  for (auto& thread : threads_)
+    thread.join();
+}
+
+size_t WorkStealingPool::GetThreadCount() const {
+  return queues_.size();
+}
+
+void WorkStealingPool::ParallelFor(size_t count,
+                                   const std::function<void(size_t)>& task) {
+  if (!count)
+    return;
+
+  task_ = &task;
+  remaining_ = count;
+  for (size_t i = 0; i < count; i++) {
+    auto& queue = *queues_[i % queues_.size()];
+    std::lock_guard<std::mutex> hold(queue.lock);
+    queue.items.push_back(i);
+  }
+
+  {
+    std::lock_guard<std::mutex> hold(lock_);
+    generation_++;
+  }
+  wake_.notify_all();
+
+  const size_t self = queues_.size() - 1;
+  while (TryRunOne(self)) {
+  }
+
+  std::unique_lock<std::mutex> hold(lock_);
+  done_.wait(hold, [this] { return remaining_ == 0; });
+}
+
+void WorkStealingPool::Work(size_t self) {
+  uint64_t seen = 0;
+  while (true) {
+    {
+      std::unique_lock<std::mutex> hold(lock_);
+      wake_.wait(hold, [&] { return stopping_ || generation_ != seen; });
+      if (stopping_)
+        return;
+      seen = generation_;
+    }
+    while (TryRunOne(self)) {
+    }
+  }
+}
+
+bool WorkStealingPool::TryRunOne(size_t self) {
+  std::optional<size_t> index;
+  {
+    auto& own = *queues_[self];
+    std::lock_guard<std::mutex> hold(own.lock);
+    if (!own.items.empty()) {
+      index = own.items.back();
+      own.items.pop_back();
+    }
+  }
+
+  for (size_t i = 1; !index.has_value() && i < queues_.size(); i++) {
+    auto& victim = *queues_[(self + i) % queues_.size()];
+    std::lock_guard<std::mutex> hold(victim.lock);
+    if (!victim.items.empty()) {
+      index = victim.items.front();
+      victim.items.pop_front();
+    }
+  }
+
+  if (!index.has_value())
+    return false;
+
+  (*task_)(*index);
+  if (--remaining_ == 0) {
+    std::lock_guard<std::mutex> hold(lock_);
+    done_.notify_all();
+  }
+  return true;
+}
+
+}  // namespace xpp::ui
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace xpp::ui {
+
+// A fixed set of workers, each with its own deque of task indices. Workers
+// drain their own deque from the back and steal from the front of everyone
+// else's once theirs is empty, so uneven tiles do not leave cores idle.
+class WorkStealingPool {
+ public:
+  explicit WorkStealingPool(size_t threads);
+  ~WorkStealingPool();
+
+  // Runs |task| for every index in [0, count). The calling thread works too,
+  // and this only returns once every index has finished. Not reentrant.
+  void ParallelFor(size_t count, const std::function<void(size_t)>& task);
+
+  size_t GetThreadCount() const;
+
+ private:
+  struct Queue {
+    std::mutex lock;
+    std::deque<size_t> items;
+  };
+
+  void Work(size_t self);
+  bool TryRunOne(size_t self);
+
+  std::vector<std::unique_ptr<Queue>> queues_;
+  const std::function<void(size_t)>* task_ = nullptr;
+  std::atomic<size_t> remaining_ = 0;
+
+  std::mutex lock_;
+  std::condition_variable wake_;
+  std::condition_variable done_;
+  uint64_t generation_ = 0;
+  bool stopping_ = false;
+
+  std::vector<std::thread> threads_;
+};
+
+}  // namespace xpp::ui
@@ -70,6 +70,34 @@ LookAndFeel* XWindow::GetLookAndFeel() const {
   return laf_.get();
 }
 
+void XWindow::SetPipelined(bool pipelined) {
+  if (!pipelined) {
+    pipeline_.reset();
+    return;
+  }
+  if (pipeline_)
+    return;
+  render_context_ = std::make_unique<RenderContext>(
+      window_gc_, colormap_, laf_, window_, depth_,
+      std::make_shared<LookAndFeel::FontCache>());
+  pipeline_ = std::make_unique<FramePipeline>(
+      [this](const FramePipeline::Frame& frame) { Present(frame); });
+}
+
+void XWindow::SetTiledRasterization(size_t threads) {
+  // The render thread presents through |rasterizer_|, so drain and stop it
+  // before swapping the rasterizer out from under it.
+  const bool pipelined = pipeline_ != nullptr;
+  pipeline_.reset();
+  if (threads)
+    rasterizer_ = std::make_unique<SoftwareRasterizer>(display_, visual_,
+                                                       threads);
+  else
+    rasterizer_.reset();
+  if (pipelined)
+    SetPipelined(true);
+}
+
 WindowInterface* XWindow::Window() const {
   return const_cast<XWindow*>(this);
 }
@@ -79,6 +107,13 @@ void XWindow::Close() {
   SetVisible(false);
 }
 
+gfx::Rect XWindow::MeasureText(std::string_view text, uint16_t font_size) {
+  gfx::Font font =
+      laf_->AllocateFont(window_gc_.get(), LookAndFeel::kDefaultFont,
+                         font_size, window_context_->fonts.get());
+  return laf_->GetTextEngine()->Measure(window_gc_.get(), font, text);
+}
+
 std::unique_ptr<XWindow> XWindow::Create(WindowType type,
                                          PositionPin position,
                                          gfx::Rect size,
@@ -102,8 +137,7 @@ bool XWindow::Initialize(WindowType mode,
   preferred_position_ = loc;
   type_ = mode;
   laf_ = std::make_shared<LookAndFeel>();
-  XVisualInfo vinfo;
-  display_->XMatchVisualInfo(display_->XDefaultScreen(), 32, TrueColor, &vinfo);
+  const XVisualInfo& vinfo = display_->GetARGBVisual();
 
   colormap_ = root_->XCreateColormap(vinfo.visual, AllocNone);
 
@@ -129,39 +163,39 @@ bool XWindow::Initialize(WindowType mode,
                                  /*border_width=*/0, vinfo.depth, InputOutput,
                                  vinfo.visual, mask, &attribs);
 
-  Atom property = display_->XInternAtom("_NET_WM_WINDOW_TYPE", False);
+  Atom property = display_->GetAtom(xlib::XAtom::kNetWmWindowType);
   Atom type;
   switch (mode) {
     case WindowType::kDesktopBackdrop: {
-      type = display_->XInternAtom("_NET_WM_WINDOW_TYPE_DESKTOP", False);
+      type = display_->GetAtom(xlib::XAtom::kNetWmWindowTypeDesktop);
       break;
     }
     case WindowType::kDesktopDock: {
-      type = display_->XInternAtom("_NET_WM_WINDOW_TYPE_DOCK", False);
+      type = display_->GetAtom(xlib::XAtom::kNetWmWindowTypeDock);
       break;
     }
     case WindowType::kApplicationToolbar: {
-      type = display_->XInternAtom("_NET_WM_WINDOW_TYPE_TOOLBAR", False);
+      type = display_->GetAtom(xlib::XAtom::kNetWmWindowTypeToolbar);
       break;
     }
     case WindowType::kApplicationMenu: {
-      type = display_->XInternAtom("_NET_WM_WINDOW_TYPE_MENU", False);
+      type = display_->GetAtom(xlib::XAtom::kNetWmWindowTypeMenu);
       break;
     }
     case WindowType::kUtilityWindow: {
-      type = display_->XInternAtom("_NET_WM_WINDOW_TYPE_UTILITY", False);
+      type = display_->GetAtom(xlib::XAtom::kNetWmWindowTypeUtility);
       break;
     }
     case WindowType::kSplashScreen: {
-      type = display_->XInternAtom("_NET_WM_WINDOW_TYPE_SPLASH", False);
+      type = display_->GetAtom(xlib::XAtom::kNetWmWindowTypeSplash);
       break;
     }
     case WindowType::kDialogPopup: {
-      type = display_->XInternAtom("_NET_WM_WINDOW_TYPE_DIALOG", False);
+      type = display_->GetAtom(xlib::XAtom::kNetWmWindowTypeDialog);
       break;
     }
     case WindowType::kNormal: {
-      type = display_->XInternAtom("_NET_WM_WINDOW_TYPE_NORMAL", False);
+      type = display_->GetAtom(xlib::XAtom::kNetWmWindowTypeNormal);
       break;
     }
   }
@@ -169,8 +203,11 @@ bool XWindow::Initialize(WindowType mode,
                            (unsigned char*)&type, 1);
 
   window_gc_ = window_->XCreateGC(colormap_);
-  window_fonts_ = std::make_shared<LookAndFeel::FontCache>(window_gc_);
   depth_ = vinfo.depth;
+  visual_ = vinfo.visual;
+  window_context_ = std::make_unique<RenderContext>(
+      window_gc_, colormap_, laf_, window_, depth_,
+      std::make_shared<LookAndFeel::FontCache>());
   return true;
 }
 
@@ -194,16 +231,73 @@ void XWindow::SetVisible(bool visibility) {
 }
 
 void XWindow::Repaint() {
+  FrameArena::Scope frame(&frame_arena_);
   if (exposed_to_ != dimensions_) {
     dimensions_ = exposed_to_;
     SetDimensions(dimensions_);
+    render_list_.Invalidate();
     // TODO: do we want a back-buffer for shrink-resizes?
   }
-  Graphics graphics(window_gc_, colormap_, laf_, window_, depth_, dimensions_,
-                    {0, 0}, window_fonts_);
+  Graphics graphics(window_context_.get(), dimensions_);
+  if (pipeline_ || rasterizer_) {
+    auto list = std::make_shared<DisplayList>();
+    graphics.SetRecording(list.get());
+    PaintTree(&graphics);
+    FramePipeline::Frame frame = {std::move(list), dimensions_};
+    if (pipeline_)
+      pipeline_->Submit(std::move(frame));
+    else
+      Present(frame);
+    return;
+  }
+
   auto canvas = graphics.CreateCanvas(dimensions_);
-  Paint(canvas->GetGraphics());
+  PaintTree(canvas->GetGraphics());
   canvas->MapOnTo(&graphics, {0, 0});
+  display_->EndFrame();
+}
+
+void XWindow::InvalidateLayout() {
+  render_list_.Invalidate();
+}
+
+void XWindow::PaintTree(Graphics* g) {
+  if (!render_list_.IsValid())
+    render_list_.Build(this, dimensions_);
+  render_list_.Paint(g);
+}
+
+void XWindow::Present(const FramePipeline::Frame& frame) {
+  if (rasterizer_) {
+    Upload(rasterizer_->Rasterize(*frame.list, frame.size), frame.size);
+    display_->XFlush();
+    display_->EndFrame();
+    return;
+  }
+
+  Graphics graphics(render_context_.get(), frame.size);
+  graphics.DrawRecording(frame.list, frame.size, {0, 0});
+  display_->XFlush();
+  display_->EndFrame();
+}
+
+void XWindow::Upload(const std::vector<uint32_t>& pixels, gfx::Rect size) {
+  XImage* image = display_->XCreateImage(
+      visual_, depth_, ZPixmap, 0,
+      reinterpret_cast<char*>(const_cast<uint32_t*>(pixels.data())),
+      size.width, size.height, 32, 0);
+  if (!image)
+    return;
+
+  // The buffer is in host order, which need not match the server's.
+  const uint32_t probe = 1;
+  image->byte_order =
+      *reinterpret_cast<const uint8_t*>(&probe) ? LSBFirst : MSBFirst;
+  window_gc_->XPutImage(image, 0, 0, 0, 0, size.width, size.height);
+
+  // The pixels belong to the rasterizer, not the image.
+  image->data = nullptr;
+  XDestroyImage(image);
 }
 
 void XWindow::RunEventLoop() {
@@ -220,7 +314,7 @@ void XWindow::RunEventLoop() {
     Repaint();
   }
 
-  Atom wmDeleteMessage = display_->XInternAtom("WM_DELETE_WINDOW", False);
+  Atom wmDeleteMessage = display_->GetAtom(xlib::XAtom::kWmDeleteWindow);
   window_->XSetWMProtocols(&wmDeleteMessage, 1);
 
   while (executing_) {
@@ -232,6 +326,9 @@ void XWindow::RunEventLoop() {
     display_->XNextEvent(&event);
     if (request_hide_flag_)
       break;
+    if (display_->HandleEvent(&event))
+      continue;
+    FrameArena::Scope frame(&frame_arena_);
     switch (event.type) {
       case EnterNotify: {
         gfx::Coord location = {event.xbutton.x, event.xbutton.y};
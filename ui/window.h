@@ -2,7 +2,12 @@
 
 #include "canvas.h"
 #include "container.h"
+#include "frame_arena.h"
+#include "frame_pipeline.h"
+#include "software_rasterizer.h"
 #include "look_and_feel.h"
+#include "render_context.h"
+#include "render_list.h"
 #include "window_interface.h"
 
 #include "../xlib/xdisplay.h"
@@ -39,12 +44,24 @@ class XWindow : public XContainer, public WindowInterface {
 
   // XContainer overrides
   void Repaint() override;
+  void InvalidateLayout() override;
   void SetVisible(bool visibility);
   LookAndFeel* GetLookAndFeel() const;
+
+  // When pipelined, Repaint() only records the component tree and a render
+  // thread rasterizes and presents it, so input handling for the next frame
+  // overlaps drawing of the current one.
+  void SetPipelined(bool pipelined);
+
+  // Rasterizes frames client-side across |threads| cores and uploads the
+  // result in one XPutImage, for trees too expensive to draw on the server.
+  // Zero threads goes back to server-side drawing.
+  void SetTiledRasterization(size_t threads);
   WindowInterface* Window() const override;
 
   // WindowInterface overrides
   void Close() override;
+  gfx::Rect MeasureText(std::string_view text, uint16_t font_size) override;
 
   static std::unique_ptr<XWindow> Create();
   static std::unique_ptr<XWindow> Create(WindowType,
@@ -55,6 +72,11 @@ class XWindow : public XContainer, public WindowInterface {
  private:
   XWindow();
   void RunEventLoop();
+  // Paints the tree from |render_list_|, flattening it again first if the
+  // layout has changed since.
+  void PaintTree(Graphics* g);
+  void Present(const FramePipeline::Frame& frame);
+  void Upload(const std::vector<uint32_t>& pixels, gfx::Rect size);
   bool Initialize(WindowType mode,
                   PositionPin positioning,
                   gfx::Rect size,
@@ -69,19 +91,31 @@ class XWindow : public XContainer, public WindowInterface {
   WindowType type_ = WindowType::kNormal;
   gfx::Coord preferred_position_ = {0, 0};
   uint32_t depth_ = 32;
+  Visual* visual_ = nullptr;
   gfx::Rect dimensions_ = {0, 0};
   gfx::Rect exposed_to_ = {0, 0};
   gfx::Coord previous_mouse_location_ = {0, 0};
   gfx::Coord press_location_ = {0, 0};
   uint8_t mouse_button_ = false;
 
+  // Layout and dispatch scratch space, released after every event.
+  FrameArena frame_arena_;
+  RenderList render_list_;
+
   std::shared_ptr<LookAndFeel> laf_;
   std::shared_ptr<xlib::XWindow> root_;
   std::shared_ptr<xlib::XWindow> window_;
   std::shared_ptr<xlib::XDisplay> display_;
   std::shared_ptr<xlib::XColorMap> colormap_;
   std::shared_ptr<xlib::XGraphics> window_gc_;
-  std::shared_ptr<LookAndFeel::FontCache> window_fonts_;
+  // Each thread that draws has its own, since font caches aren't shared.
+  std::unique_ptr<RenderContext> window_context_;
+  std::unique_ptr<RenderContext> render_context_;
+  std::unique_ptr<SoftwareRasterizer> rasterizer_;
+
+  // Declared last so the render thread is joined before anything it uses is
+  // torn down.
+  std::unique_ptr<FramePipeline> pipeline_;
 };
 
 }  // namespace xpp::ui
\ No newline at end of file
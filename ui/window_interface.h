@@ -1,10 +1,19 @@
 #pragma once
 
+#include <string_view>
+
+#include "../gfx/rect.h"
+
 namespace xpp::ui {
 
 class WindowInterface {
  public:
   virtual void Close() = 0;
+
+  // How much room |text| needs in the default font at |font_size|, for
+  // components working out their preferred size outside of Paint().
+  virtual gfx::Rect MeasureText(std::string_view text,
+                                uint16_t font_size) = 0;
 };
 
 }  // namespace xpp::ui
\ No newline at end of file
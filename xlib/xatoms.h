@@ -0,0 +1,59 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace xpp::xlib {
+
+// The ICCCM and EWMH atoms this library uses. XDisplay interns all of them
+// in a single round trip the first time any one is asked for.
+enum class XAtom : uint8_t {
+  kWmProtocols,
+  kWmDeleteWindow,
+  kWmTakeFocus,
+  kNetWmName,
+  kNetWmPid,
+  kNetWmState,
+  kNetWmStateAbove,
+  kNetWmStateFullscreen,
+  kNetWmWindowType,
+  kNetWmWindowTypeDesktop,
+  kNetWmWindowTypeDock,
+  kNetWmWindowTypeToolbar,
+  kNetWmWindowTypeMenu,
+  kNetWmWindowTypeUtility,
+  kNetWmWindowTypeSplash,
+  kNetWmWindowTypeDialog,
+  kNetWmWindowTypeNormal,
+  kUtf8String,
+};
+
+// Indexed by XAtom.
+inline constexpr std::array kXAtomNames = {
+    "WM_PROTOCOLS",
+    "WM_DELETE_WINDOW",
+    "WM_TAKE_FOCUS",
+    "_NET_WM_NAME",
+    "_NET_WM_PID",
+    "_NET_WM_STATE",
+    "_NET_WM_STATE_ABOVE",
+    "_NET_WM_STATE_FULLSCREEN",
+    "_NET_WM_WINDOW_TYPE",
+    "_NET_WM_WINDOW_TYPE_DESKTOP",
+    "_NET_WM_WINDOW_TYPE_DOCK",
+    "_NET_WM_WINDOW_TYPE_TOOLBAR",
+    "_NET_WM_WINDOW_TYPE_MENU",
+    "_NET_WM_WINDOW_TYPE_UTILITY",
+    "_NET_WM_WINDOW_TYPE_SPLASH",
+    "_NET_WM_WINDOW_TYPE_DIALOG",
+    "_NET_WM_WINDOW_TYPE_NORMAL",
+    "UTF8_STRING",
+};
+
+inline constexpr size_t kXAtomCount = kXAtomNames.size();
+
+static_assert(static_cast<size_t>(XAtom::kUtf8String) + 1 == kXAtomCount,
+              "kXAtomNames is out of sync with XAtom");
+
+}  // namespace xpp::xlib
@@ -3,14 +3,42 @@
 
 namespace xpp::xlib {
 
-XColorMap::~XColorMap() = default;
+XColorMap::~XColorMap() {
+  if (xft_draw_)
+    XftDrawDestroy(xft_draw_);
+}
 
 XColorMap::XColorMap(::Colormap colormap,
                      std::shared_ptr<XWindow> window,
-                     std::shared_ptr<XDisplay> display) {
+                     std::shared_ptr<XDisplay> display,
+                     Visual* visual)
+    : visual_(visual), converter_(visual) {
   display_ = display;
   window_ = std::move(window);
   colormap_ = colormap;
 }
 
-}  // namespace xpp::xlib
+unsigned long XColorMap::Pixel(uint16_t red, uint16_t green, uint16_t blue) {
+  if (converter_.IsDirect())
+    return converter_.Convert(red, green, blue);
+
+  XColor xcolor;
+  xcolor.red = red;
+  xcolor.green = green;
+  xcolor.blue = blue;
+  XAllocColor(&xcolor);
+  return xcolor.pixel;
+}
+
+XftDraw* XColorMap::GetXftDraw(::Drawable drawable) {
+  if (!xft_draw_) {
+    xft_draw_ = display_->XftDrawCreate(drawable, visual_, colormap_);
+    xft_target_ = drawable;
+  } else if (xft_target_ != drawable) {
+    display_->XftDrawChange(xft_draw_, drawable);
+    xft_target_ = drawable;
+  }
+  return xft_draw_;
+}
+
+}  // namespace xpp::xlib
\ No newline at end of file
@@ -4,6 +4,7 @@
 
 #include "xdisplay.h"
 #include "xorg_typemap.h"
+#include "xpixel_converter.h"
 
 namespace xpp::xlib {
 
@@ -20,15 +21,30 @@ class XColorMap {
 
   ::Colormap colormap() { return colormap_; }
 
+  // Computed locally on TrueColor visuals, allocated from the server
+  // otherwise.
+  unsigned long Pixel(uint16_t red, uint16_t green, uint16_t blue);
+
+  // Every canvas of a window shares its colormap, so they all share this one
+  // XftDraw, which is pointed at |drawable| only when it was last used with
+  // a different one.
+  XftDraw* GetXftDraw(::Drawable drawable);
+
  private:
   std::shared_ptr<XWindow> window_;
   std::shared_ptr<XDisplay> display_;
   ::Colormap colormap_;
+  Visual* visual_;
+  XPixelConverter converter_;
+
+  XftDraw* xft_draw_ = nullptr;
+  ::Drawable xft_target_ = None;
 
   // Private constructor. Must come from the display!
   XColorMap(::Colormap colormap,
             std::shared_ptr<XWindow> window,
-            std::shared_ptr<XDisplay> display);
+            std::shared_ptr<XDisplay> display,
+            Visual* visual);
 
   // Allow XWindow to create XColorMap
   friend struct Traits<XColorMap>;
@@ -1,5 +1,10 @@
 
 #include "xdisplay.h"
+
+#include <cstring>
+#include <string>
+#include <vector>
+
 #include "xpixmap.h"
 #include "xwindow.h"
 
@@ -22,12 +27,25 @@ Traits<XPixmap>::XppType Traits<XPixmap>::Import(
 }
 
 XDisplay::~XDisplay() {
+  monitors_.reset();
+  resource_pool_.reset();
+  font_cache_.reset();
   XCloseDisplay(display_);
 }
 
 XDisplay::XDisplay(const char* id) {
+  // Windows may hand rasterization to a render thread at any point, and Xlib
+  // has to be told before the first connection is opened.
+  static bool threads_initialized = XInitThreads();
+  (void)threads_initialized;
   display_ = XOpenDisplay(id);
   MCHECK(display_, "Could not open display\n");
+  connection_ = ::XGetXCBConnection(display_);
+  font_cache_ =
+      std::make_shared<XFontCache>(this, ::XDefaultScreen(display_));
+  resource_pool_ = std::make_unique<XResourcePool>(this);
+  ::XMatchVisualInfo(display_, ::XDefaultScreen(display_), 32, TrueColor,
+                     &argb_visual_);
 }
 
 std::shared_ptr<XDisplay> XDisplay::Create(const char* id) {
@@ -35,50 +53,85 @@ std::shared_ptr<XDisplay> XDisplay::Create(const char* id) {
   return ptr;
 }
 
-// static
+std::shared_ptr<XFontCache> XDisplay::GetFontCache() const {
+  return font_cache_;
+}
+
+const XVisualInfo& XDisplay::GetARGBVisual() const {
+  return argb_visual_;
+}
+
+Atom XDisplay::GetAtom(XAtom atom) {
+  std::call_once(atoms_interned_, [this] {
+    // Every request is out before the first reply is waited on, so the
+    // whole table costs one round trip.
+    std::vector<decltype(xcb_intern_atom(0, 0, nullptr))> replies;
+    replies.reserve(kXAtomCount);
+    for (const char* name : kXAtomNames)
+      replies.push_back(xcb_intern_atom(0, std::strlen(name), name));
+    for (size_t i = 0; i < kXAtomCount; i++)
+      atoms_[i] = replies[i].Get() ? replies[i]->atom : None;
+  });
+  return atoms_[static_cast<size_t>(atom)];
+}
+
+XResourcePool* XDisplay::GetResourcePool() const {
+  return resource_pool_.get();
+}
+
+std::shared_ptr<XPixmap> XDisplay::AcquirePixmap(::Drawable drawable,
+                                                 uint32_t width,
+                                                 uint32_t height,
+                                                 uint32_t depth) {
+  auto key = XResourcePool::GetPixmapKey(width, height, depth);
+  auto pixmap = Traits<XPixmap>::Import(
+      resource_pool_->AcquirePixmap(drawable, key), shared_from_this());
+  pixmap->pool_key_ = key;
+  return pixmap;
+}
+
+void XDisplay::EndFrame() {
+  resource_pool_->Trim();
+#ifdef XPP_X_STATS
+  stats_->EndFrame();
+#endif
+}
+
+XProtocolStats::Snapshot XDisplay::GetStats() const {
+#ifdef XPP_X_STATS
+  return stats_->GetSnapshot();
+#else
+  return {};
+#endif
+}
+
+void XDisplay::SetStatsDumpInterval(uint32_t frames) {
+#ifdef XPP_X_STATS
+  stats_->SetDumpInterval(frames);
+#else
+  (void)frames;
+#endif
+}
+
+XMonitorTopology* XDisplay::GetMonitors() {
+  std::call_once(monitors_created_, [this] {
+    monitors_ = std::make_unique<XMonitorTopology>(this);
+    monitors_ready_.store(monitors_.get(), std::memory_order_release);
+  });
+  return monitors_.get();
+}
+
 std::map<std::string, gfx::Rect> XDisplay::GetMonitorSizes() {
   std::map<std::string, gfx::Rect> result;
-  auto display = XDisplay::Create();
-  auto root = display->XRootWindow(display->XDefaultScreen());
-
-  XRRScreenResources* xrr_resources = root->XRRGetScreenResourcesCurrent();
-  if (!xrr_resources || xrr_resources->noutput <= 0) {
-    XRRFreeScreenResources(xrr_resources);
-    return result;
-  }
-
-  for (int i = 0; i < xrr_resources->ncrtc; i++) {
-    XRROutputInfo* xrr_output =
-        display->XRRGetOutputInfo(xrr_resources, xrr_resources->outputs[i]);
-
-    if (!xrr_output) {
-      XRRFreeScreenResources(xrr_resources);
-      return result;
-    }
-
-    if (!xrr_output->mm_height) {
-      XRRFreeOutputInfo(xrr_output);
-      XRRFreeScreenResources(xrr_resources);
-      return result;
-    }
-
-    XRRCrtcInfo* xrr_crtc =
-        display->XRRGetCrtcInfo(xrr_resources, xrr_output->crtc);
-
-    if (!xrr_crtc) {
-      XRRFreeOutputInfo(xrr_output);
-      XRRFreeScreenResources(xrr_resources);
-      return result;
-    }
-
-    result.insert({xrr_output->name, {xrr_crtc->width, xrr_crtc->height}});
-
-    XRRFreeCrtcInfo(xrr_crtc);
-    XRRFreeOutputInfo(xrr_output);
-  }
-
-  XRRFreeScreenResources(xrr_resources);
+  for (const XMonitor& monitor : GetMonitors()->GetLayout()->monitors)
+    result.insert({monitor.name, monitor.size});
   return result;
 }
 
+bool XDisplay::HandleEvent(XEvent* event) {
+  XMonitorTopology* monitors =
+      monitors_ready_.load(std::memory_order_acquire);
+  return monitors && monitors->HandleEvent(event);
+}
+
 }  // namespace xpp::xlib
@@ -1,47 +1,101 @@
 #pragma once
 
+#include <array>
+#include <atomic>
 #include <cstdio>
 #include <map>
 #include <memory>
+#include <mutex>
 
 #include <X11/XKBlib.h>
 #include <X11/Xft/Xft.h>
+#include <X11/Xlib-xcb.h>
 #include <X11/Xlib.h>
 #include <X11/Xutil.h>
 #include <X11/extensions/Xinerama.h>
 #include <X11/extensions/Xrandr.h>
 #include <X11/extensions/Xrender.h>
+#include <xcb/randr.h>
+#include <xcb/xcb.h>
 
 #include "xpp/gfx/coord.h"
 #include "xpp/gfx/rect.h"
 
+#include "xatoms.h"
+#include "xfont_cache.h"
+#include "xmonitors.h"
 #include "xorg_typemap.h"
+#include "xreply.h"
+#include "xresource_pool.h"
+#include "xstats.h"
 
 namespace xpp::xlib {
 
+// Every wrapper below counts and times its call when built with
+// XPP_X_STATS defined. Without it this expands to nothing.
+#ifdef XPP_X_STATS
+#define X_STATS_SCOPE(fn)                                            \
+  static const size_t fn##_slot = XProtocolStats::Register(#fn);     \
+  XProtocolStats::Scope fn##_scope(stats_.get(), fn##_slot)
+// Where an XReply counts the wait for its reply.
+#define X_STATS_REPLY(fn)                                              \
+  , stats_.get(), [] {                                                 \
+    static const size_t slot = XProtocolStats::Register(#fn "_reply"); \
+    return slot;                                                       \
+  }()
+#else
+#define X_STATS_SCOPE(fn)
+#define X_STATS_REPLY(fn)
+#endif
+
 #define NO_CONVERSIONS(fn, ret)                         \
   template <typename... Args>                           \
   ret fn(Args&&... args) {                              \
+    X_STATS_SCOPE(fn);                                  \
     return ::fn(display_, std::forward<Args>(args)...); \
   }
 
 #define NO_RETURN(fn)                            \
   template <typename... Args>                    \
   void fn(Args&&... args) {                      \
+    X_STATS_SCOPE(fn);                           \
     ::fn(display_, std::forward<Args>(args)...); \
   }
 
+// Calls that don't take the display, counted all the same.
+#define NO_DISPLAY(fn, ret)                   \
+  template <typename... Args>                 \
+  ret fn(Args&&... args) {                    \
+    X_STATS_SCOPE(fn);                        \
+    return ::fn(std::forward<Args>(args)...); \
+  }
+
 #define CONVERT_RETURN(fn, traits, ...)                                \
   template <typename... Args>                                          \
   traits::XppType fn(Args&&... args) {                                 \
+    X_STATS_SCOPE(fn);                                                 \
     return traits::Import(::fn(display_, std::forward<Args>(args)...), \
                           shared_from_this(), ##__VA_ARGS__);          \
   }                                                                    \
   template <typename... Args>                                          \
   decltype(auto) fn##Raw(Args&&... args) {                             \
+    X_STATS_SCOPE(fn);                                                 \
     return ::fn(display_, std::forward<Args>(args)...);                \
   }
 
+// The same requests over the XCB connection underneath Xlib. Requests that
+// have replies return an XReply instead of waiting for it, so they can be
+// sent back to back and collected afterwards. Sending is counted under
+// |fn|, and the wait under fn_reply.
+#define XCB_REPLY(fn)                                                       \
+  template <typename... Args>                                               \
+  auto fn(Args&&... args) {                                                 \
+    X_STATS_SCOPE(fn);                                                      \
+    return MakeXReply(connection_,                                          \
+                      ::fn(connection_, std::forward<Args>(args)...),       \
+                      &::fn##_reply X_STATS_REPLY(fn));                     \
+  }
+
 // Forward declare.
 class XColorMap;
 class XDisplay;
@@ -69,12 +123,44 @@ struct Traits<XPixmap> {
 class XDisplay : public std::enable_shared_from_this<XDisplay> {
  public:
   static std::shared_ptr<XDisplay> Create(const char* id = nullptr);
-  static std::map<std::string, gfx::Rect> GetMonitorSizes();
   static constexpr Atom kAtom = 4;
   ~XDisplay();
 
   using XWindowTraits = Traits<XWindow>;
 
+  // Every font opened for drawing on this display should come from here.
+  std::shared_ptr<XFontCache> GetFontCache() const;
+
+  // The 32 bit TrueColor visual, matched once when the display is opened.
+  // |visual| is null if the screen doesn't have one.
+  const XVisualInfo& GetARGBVisual() const;
+
+  // The first call interns every XAtom with one XInternAtoms request; after
+  // that this is a lookup.
+  Atom GetAtom(XAtom atom);
+
+  // Scanned on first use and kept current by HandleEvent().
+  XMonitorTopology* GetMonitors();
+  std::map<std::string, gfx::Rect> GetMonitorSizes();
+
+  // Gives the display a look at |event| before the window does. Returns true
+  // if the display consumed it.
+  bool HandleEvent(XEvent* event);
+
+  // Offscreen pixmaps and GCs are recycled through here.
+  XResourcePool* GetResourcePool() const;
+  std::shared_ptr<XPixmap> AcquirePixmap(::Drawable drawable,
+                                         uint32_t width,
+                                         uint32_t height,
+                                         uint32_t depth);
+
+  // Marks the end of a frame, which ages the idle pooled resources and
+  // closes a frame of request statistics. The statistics and the dump
+  // interval only do anything when built with XPP_X_STATS.
+  void EndFrame();
+  XProtocolStats::Snapshot GetStats() const;
+  void SetStatsDumpInterval(uint32_t frames);
+
   NO_CONVERSIONS(XDisplayWidth, int);
   NO_CONVERSIONS(XkbKeycodeToKeysym, KeySym);
   NO_CONVERSIONS(XDisplayHeight, int);
@@ -85,12 +171,18 @@ class XDisplay : public std::enable_shared_from_this<XDisplay> {
   NO_CONVERSIONS(XftFontOpenName, XftFont*);
   NO_CONVERSIONS(XftFontClose, void);
   NO_CONVERSIONS(XftDrawCreate, XftDraw*);
+  NO_DISPLAY(XftDrawChange, void);
+  NO_DISPLAY(XftDrawGlyphSpec, void);
   NO_CONVERSIONS(XftColorAllocValue, bool);
   NO_CONVERSIONS(XftColorFree, void);
   NO_CONVERSIONS(XftTextExtentsUtf8, void);
+  NO_CONVERSIONS(XftCharIndex, FT_UInt);
+  NO_CONVERSIONS(XftGlyphExtents, void);
+  NO_CONVERSIONS(XCreateImage, XImage*);
   NO_CONVERSIONS(XRRGetScreenResourcesCurrent, XRRScreenResources*);
   NO_CONVERSIONS(XRRGetOutputInfo, XRROutputInfo*);
   NO_CONVERSIONS(XRRGetCrtcInfo, XRRCrtcInfo*);
+  NO_CONVERSIONS(XRRQueryExtension, Bool);
   NO_CONVERSIONS(XInternAtom, Atom);
   NO_CONVERSIONS(XChangeProperty, int);
 
@@ -101,37 +193,72 @@ class XDisplay : public std::enable_shared_from_this<XDisplay> {
   NO_RETURN(XDestroyWindow);
   NO_RETURN(XFreePixmap);
   NO_RETURN(XNextEvent);
+  NO_RETURN(XFlush);
   NO_RETURN(XMapWindow);
   NO_RETURN(XMapRaised);
   NO_RETURN(XUnmapWindow);
   NO_RETURN(XMatchVisualInfo);
   NO_RETURN(XSelectInput);
   NO_RETURN(XFreeGC);
+  NO_RETURN(XChangeGC);
   NO_RETURN(XFillRectangle);
+  NO_RETURN(XFillRectangles);
   NO_RETURN(XDrawRectangle);
+  NO_RETURN(XDrawRectangles);
   NO_RETURN(XDrawArc);
+  NO_RETURN(XDrawArcs);
   NO_RETURN(XFillArc);
+  NO_RETURN(XFillArcs);
   NO_RETURN(XDrawLine);
+  NO_RETURN(XDrawSegments);
   NO_RETURN(XSetLineAttributes);
   NO_RETURN(XDrawString);
   NO_RETURN(XSetForeground);
+  NO_RETURN(XSetClipRectangles);
+  NO_RETURN(XSetClipMask);
   NO_RETURN(XAllocColor);
   NO_RETURN(XSendEvent);
   NO_RETURN(XCopyArea);
+  NO_RETURN(XPutImage);
   NO_RETURN(XFreeFont);
   NO_RETURN(XSetFont);
   NO_RETURN(XResizeWindow);
   NO_RETURN(XMoveWindow);
   NO_RETURN(XMoveResizeWindow);
   NO_RETURN(XSetWMProtocols);
+  NO_RETURN(XRRSelectInput);
+
+  XCB_REPLY(xcb_intern_atom);
+  XCB_REPLY(xcb_randr_get_screen_resources_current);
+  XCB_REPLY(xcb_randr_get_output_info);
+  XCB_REPLY(xcb_randr_get_crtc_info);
+  XCB_REPLY(xcb_randr_get_output_primary);
 
  private:
   XDisplay(const char* id);
   ::Display* display_;
+  // Owned by |display_|. Xlib keeps the event queue.
+  xcb_connection_t* connection_;
+  std::shared_ptr<XFontCache> font_cache_;
+  std::unique_ptr<XResourcePool> resource_pool_;
+  XVisualInfo argb_visual_ = {};
+  std::once_flag atoms_interned_;
+  std::array<Atom, kXAtomCount> atoms_ = {};
+  std::once_flag monitors_created_;
+  std::unique_ptr<XMonitorTopology> monitors_;
+  // Set once |monitors_| is, for the event thread to check without a lock.
+  std::atomic<XMonitorTopology*> monitors_ready_ = nullptr;
+#ifdef XPP_X_STATS
+  std::unique_ptr<XProtocolStats> stats_ = std::make_unique<XProtocolStats>();
+#endif
 };
 
 #undef NO_CONVERSIONS
 #undef NO_RETURN
+#undef NO_DISPLAY
 #undef CONVERT_RETURN
+#undef XCB_REPLY
+#undef X_STATS_SCOPE
+#undef X_STATS_REPLY
 
 }  // namespace xpp::xlib
\ No newline at end of file
@@ -3,12 +3,29 @@
 #include "base/check.h"
 #include "xdisplay.h"
 #include "xgraphics.h"
+#include "xpixmap.h"
 
 namespace xpp::xlib {
 
 XDrawable::XDrawable(std::shared_ptr<XDisplay> display)
     : display_(std::move(display)) {}
 
+std::shared_ptr<XPixmap> XDrawable::AcquirePixmap(uint32_t width,
+                                                  uint32_t height,
+                                                  uint32_t depth) {
+  return display_->AcquirePixmap(Drawable(), width, height, depth);
+}
+
+Traits<XGraphics>::XppType XDrawable::AcquireGC(
+    std::shared_ptr<XColorMap> cmap,
+    uint32_t depth) {
+  auto graphics = Traits<XGraphics>::Import(
+      display_->GetResourcePool()->AcquireGC(Drawable(), depth),
+      shared_from_this(), display_, std::move(cmap));
+  graphics->pool_depth_ = depth;
+  return graphics;
+}
+
 Traits<XGraphics>::XppType Traits<XGraphics>::Import(
     const XorgType& graphics,
     std::shared_ptr<XDrawable> drawable,
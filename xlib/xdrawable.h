@@ -47,12 +47,26 @@ class XDrawable : public std::enable_shared_from_this<XDrawable> {
         display_, std::move(cmap));
   }
 
+  // Pooled versions of XCreatePixmap() and XCreateGC(). The pixmap may be
+  // larger than asked for, and |depth| has to be this drawable's depth.
+  std::shared_ptr<XPixmap> AcquirePixmap(uint32_t width,
+                                         uint32_t height,
+                                         uint32_t depth);
+  Traits<XGraphics>::XppType AcquireGC(std::shared_ptr<XColorMap> cmap,
+                                       uint32_t depth);
+
   NO_CONVERSIONS(XFillRectangle, void);
+  NO_CONVERSIONS(XFillRectangles, void);
   NO_CONVERSIONS(XDrawRectangle, void);
+  NO_CONVERSIONS(XDrawRectangles, void);
   NO_CONVERSIONS(XDrawString, void);
   NO_CONVERSIONS(XDrawArc, void);
+  NO_CONVERSIONS(XDrawArcs, void);
   NO_CONVERSIONS(XFillArc, void);
+  NO_CONVERSIONS(XFillArcs, void);
   NO_CONVERSIONS(XDrawLine, void);
+  NO_CONVERSIONS(XDrawSegments, void);
+  NO_CONVERSIONS(XPutImage, void);
   NO_CONVERSIONS(XftFontOpenName, XftFont*);
   NO_CONVERSIONS(XftDrawCreate, XftDraw*);
 
@@ -0,0 +1,107 @@
+#include "xfont_cache.h"
+
+#include "xdisplay.h"
+
+namespace xpp::xlib {
+
+XFontCache::XFontCache(XDisplay* display, int screen, size_t max_idle)
+    : display_(display), screen_(screen), max_idle_(max_idle) {}
+
+XFontCache::~XFontCache() {
+  for (const Key& key : idle_)
+    display_->XftFontClose(entries_.at(key).font);
+}
+
+std::shared_ptr<XftFont> XFontCache::Find(const std::string& name,
+                                          uint16_t size) {
+  std::lock_guard<std::mutex> hold(lock_);
+  Key key = {name, size};
+  auto itr = entries_.find(key);
+  if (itr == entries_.end())
+    return nullptr;
+  return Acquire(key, &itr->second);
+}
+
+std::shared_ptr<XftFont> XFontCache::Open(const std::string& name,
+                                          uint16_t size) {
+  if (auto found = Find(name, size))
+    return found;
+
+  // Opening is a round trip, so it runs unlocked rather than hold up Find()
+  // and handle deleters on the other thread.
+  std::string pattern = name + ":size=" + std::to_string(size);
+  XftFont* font = display_->XftFontOpenName(screen_, pattern.c_str());
+  if (!font)
+    return nullptr;
+
+  std::shared_ptr<XftFont> handle;
+  bool raced;
+  {
+    std::lock_guard<std::mutex> hold(lock_);
+    Key key = {name, size};
+    auto [entry, inserted] =
+        entries_.try_emplace(key, Entry{font, {}, idle_.end()});
+    raced = !inserted;
+    if (inserted)
+      stats_.opened++;
+    handle = Acquire(key, &entry->second);
+  }
+  // Another thread opened the same font meanwhile; keep the one it cached.
+  if (raced)
+    display_->XftFontClose(font);
+  return handle;
+}
+
+XFontCache::Stats XFontCache::GetStats() const {
+  std::lock_guard<std::mutex> hold(lock_);
+  return stats_;
+}
+
+std::shared_ptr<XftFont> XFontCache::Acquire(const Key& key, Entry* entry) {
+  if (auto live = entry->live.lock()) {
+    stats_.hits++;
+    return live;
+  }
+
+  if (entry->is_idle) {
+    idle_.erase(entry->idle);
+    entry->is_idle = false;
+    stats_.revived++;
+  }
+
+  // The deleter only parks the font; closing it is up to the idle list.
+  std::weak_ptr<XFontCache> cache = weak_from_this();
+  std::shared_ptr<XftFont> handle(entry->font, [cache, key](XftFont*) {
+    if (auto self = cache.lock())
+      self->Release(key);
+  });
+  entry->live = handle;
+  return handle;
+}
+
+void XFontCache::Release(const Key& key) {
+  std::lock_guard<std::mutex> hold(lock_);
+  auto itr = entries_.find(key);
+  if (itr == entries_.end())
+    return;
+
+  // The font may have been handed out again between the last handle dying
+  // and this deleter getting the lock.
+  Entry& entry = itr->second;
+  if (!entry.live.expired() || entry.is_idle)
+    return;
+
+  idle_.push_front(key);
+  entry.idle = idle_.begin();
+  entry.is_idle = true;
+
+  while (idle_.size() > max_idle_) {
+    auto evicted = entries_.find(idle_.back());
+    display_->XftFontClose(evicted->second.font);
+    entries_.erase(evicted);
+    idle_.pop_back();
+    stats_.evicted++;
+  }
+}
+
+}  // namespace xpp::xlib
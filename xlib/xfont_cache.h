@@ -0,0 +1,77 @@
+#pragma once
+
+#include <cstdint>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include <X11/Xft/Xft.h>
+#include <X11/Xlib.h>
+
+namespace xpp::xlib {
+
+class XDisplay;
+
+// Xft fonts opened on one display and shared by everything that draws to
+// it. Handles are reference counted; when the last one for a font goes away
+// the font stays open on an idle list, and the least recently used idle
+// fonts are closed once more than |max_idle| of them pile up.
+class XFontCache : public std::enable_shared_from_this<XFontCache> {
+ public:
+  struct Stats {
+    uint64_t hits = 0;
+    uint64_t revived = 0;
+    uint64_t opened = 0;
+    uint64_t evicted = 0;
+  };
+
+  // Opens and closes fonts through |display|'s wrappers, so they show up in
+  // its protocol stats.
+  XFontCache(XDisplay* display, int screen, size_t max_idle = 8);
+
+  // Closes the idle fonts. Fonts with live handles are left to Xft, which
+  // frees them along with the display.
+  ~XFontCache();
+
+  // Returns the font for |name| at |size| if it is already open, live or
+  // idle, without going anywhere near fontconfig.
+  std::shared_ptr<XftFont> Find(const std::string& name, uint16_t size);
+
+  // Like Find(), but opens the font if it has to. Null if Xft can't match it.
+  // The open happens without |lock_| held.
+  std::shared_ptr<XftFont> Open(const std::string& name, uint16_t size);
+
+  Stats GetStats() const;
+
+ private:
+  using Key = std::pair<std::string, uint16_t>;
+
+  struct Entry {
+    XftFont* font;
+    std::weak_ptr<XftFont> live;
+    // Only meaningful while the font has no handles.
+    std::list<Key>::iterator idle;
+    bool is_idle = false;
+  };
+
+  // Expects |lock_| to be held.
+  std::shared_ptr<XftFont> Acquire(const Key& key, Entry* entry);
+  // Called by a handle's deleter, from any thread; takes |lock_| itself.
+  void Release(const Key& key);
+
+  // Owns the cache.
+  XDisplay* display_;
+  int screen_;
+  size_t max_idle_;
+
+  // Handles can be dropped from the render thread.
+  mutable std::mutex lock_;
+  std::map<Key, Entry> entries_;
+  // Most recently released first.
+  std::list<Key> idle_;
+  Stats stats_;
+};
+
+}  // namespace xpp::xlib
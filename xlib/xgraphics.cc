@@ -1,10 +1,15 @@
 
 #include "xgraphics.h"
 
+#include <algorithm>
+
 namespace xpp::xlib {
 
 XGraphics::~XGraphics() {
-  display_->XFreeGC(graphics_);
+  if (pool_depth_)
+    display_->GetResourcePool()->ReleaseGC(graphics_, *pool_depth_);
+  else
+    display_->XFreeGC(graphics_);
 }
 
 XGraphics::XGraphics(::GC graphics,
@@ -17,6 +22,159 @@ XGraphics::XGraphics(::GC graphics,
   graphics_ = graphics;
 }
 
+void XGraphics::XSetForeground(unsigned long pixel) {
+  if (foreground_ == pixel) {
+    stats_.foreground_elided++;
+    return;
+  }
+  FlushQueued();
+  display_->XSetForeground(graphics_, pixel);
+  foreground_ = pixel;
+  stats_.foreground_sent++;
+}
+
+void XGraphics::XSetFont(::Font font) {
+  if (font_ == font) {
+    stats_.font_elided++;
+    return;
+  }
+  FlushQueued();
+  display_->XSetFont(graphics_, font);
+  font_ = font;
+  stats_.font_sent++;
+}
+
+void XGraphics::XSetLineAttributes(uint width,
+                                   int line_style,
+                                   int cap,
+                                   int join) {
+  LineAttributes attributes = {width, line_style, cap, join};
+  if (line_attributes_ == attributes) {
+    stats_.line_attributes_elided++;
+    return;
+  }
+  FlushQueued();
+  display_->XSetLineAttributes(graphics_, width, line_style, cap, join);
+  line_attributes_ = attributes;
+  stats_.line_attributes_sent++;
+}
+
+void XGraphics::XSetClipRectangles(int x,
+                                   int y,
+                                   const XRectangle* rects,
+                                   int n) {
+  if (clip_.has_value() && clip_->enabled && clip_->x == x && clip_->y == y &&
+      clip_->rects.size() == static_cast<size_t>(n) &&
+      std::equal(rects, rects + n, clip_->rects.begin(),
+                 [](const XRectangle& a, const XRectangle& b) {
+                   return a.x == b.x && a.y == b.y && a.width == b.width &&
+                          a.height == b.height;
+                 })) {
+    stats_.clip_elided++;
+    return;
+  }
+  FlushQueued();
+  clip_ = Clip{true, x, y, {rects, rects + n}};
+  display_->XSetClipRectangles(graphics_, x, y, clip_->rects.data(), n,
+                               Unsorted);
+  stats_.clip_sent++;
+}
+
+void XGraphics::XClearClip() {
+  if (clip_.has_value() && !clip_->enabled) {
+    stats_.clip_elided++;
+    return;
+  }
+  FlushQueued();
+  clip_ = Clip{false, 0, 0, {}};
+  display_->XSetClipMask(graphics_, None);
+  stats_.clip_sent++;
+}
+
+const XGraphics::StateStats& XGraphics::GetStateStats() const {
+  return stats_;
+}
+
+void XGraphics::QueueFillRectangle(int x, int y, uint w, uint h) {
+  fill_rectangles_.push_back({static_cast<short>(x), static_cast<short>(y),
+                              static_cast<unsigned short>(w),
+                              static_cast<unsigned short>(h)});
+  has_queued_ = true;
+}
+
+void XGraphics::QueueDrawRectangle(int x, int y, uint w, uint h) {
+  draw_rectangles_.push_back({static_cast<short>(x), static_cast<short>(y),
+                              static_cast<unsigned short>(w),
+                              static_cast<unsigned short>(h)});
+  has_queued_ = true;
+}
+
+void XGraphics::QueueFillArc(int x,
+                             int y,
+                             uint w,
+                             uint h,
+                             int angle1,
+                             int angle2) {
+  fill_arcs_.push_back({static_cast<short>(x), static_cast<short>(y),
+                        static_cast<unsigned short>(w),
+                        static_cast<unsigned short>(h),
+                        static_cast<short>(angle1),
+                        static_cast<short>(angle2)});
+  has_queued_ = true;
+}
+
+void XGraphics::QueueDrawArc(int x,
+                             int y,
+                             uint w,
+                             uint h,
+                             int angle1,
+                             int angle2) {
+  draw_arcs_.push_back({static_cast<short>(x), static_cast<short>(y),
+                        static_cast<unsigned short>(w),
+                        static_cast<unsigned short>(h),
+                        static_cast<short>(angle1),
+                        static_cast<short>(angle2)});
+  has_queued_ = true;
+}
+
+void XGraphics::QueueDrawLine(int x1, int y1, int x2, int y2) {
+  segments_.push_back({static_cast<short>(x1), static_cast<short>(y1),
+                       static_cast<short>(x2), static_cast<short>(y2)});
+  has_queued_ = true;
+}
+
+void XGraphics::FlushQueued() {
+  if (!has_queued_)
+    return;
+  has_queued_ = false;
+
+  if (!fill_rectangles_.empty()) {
+    drawable_->XFillRectangles(graphics_, fill_rectangles_.data(),
+                               static_cast<int>(fill_rectangles_.size()));
+    fill_rectangles_.clear();
+  }
+  if (!fill_arcs_.empty()) {
+    drawable_->XFillArcs(graphics_, fill_arcs_.data(),
+                         static_cast<int>(fill_arcs_.size()));
+    fill_arcs_.clear();
+  }
+  if (!draw_rectangles_.empty()) {
+    drawable_->XDrawRectangles(graphics_, draw_rectangles_.data(),
+                               static_cast<int>(draw_rectangles_.size()));
+    draw_rectangles_.clear();
+  }
+  if (!segments_.empty()) {
+    drawable_->XDrawSegments(graphics_, segments_.data(),
+                             static_cast<int>(segments_.size()));
+    segments_.clear();
+  }
+  if (!draw_arcs_.empty()) {
+    drawable_->XDrawArcs(graphics_, draw_arcs_.data(),
+                         static_cast<int>(draw_arcs_.size()));
+    draw_arcs_.clear();
+  }
+}
+
 ::GC XGraphics::operator*() {
   return graphics_;
 }
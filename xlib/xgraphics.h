@@ -1,6 +1,8 @@
 #pragma once
 
 #include <memory>
+#include <optional>
+#include <vector>
 
 #include "xcolormap.h"
 #include "xorg_typemap.h"
@@ -8,18 +10,15 @@
 
 namespace xpp::xlib {
 
+// Anything that draws outside of the primitive queue has to let the queue out
+// first, or the two would reach the server out of order.
 #define DRAWABLE_METHOD(fn, ret)                                  \
   template <typename... Args>                                     \
   ret fn(Args&&... args) {                                        \
+    FlushQueued();                                                \
     return drawable_->fn(graphics_, std::forward<Args>(args)...); \
   }
 
-#define DISPLAY_METHOD(fn, ret)                                  \
-  template <typename... Args>                                    \
-  ret fn(Args&&... args) {                                       \
-    return display_->fn(graphics_, std::forward<Args>(args)...); \
-  }
-
 #define DISPLAY_METHOD_PASSTHROUGH(fn, ret)           \
   template <typename... Args>                         \
   ret fn(Args&&... args) {                            \
@@ -42,43 +41,73 @@ class XGraphics {
   DRAWABLE_METHOD(XFillArc, void);
   DRAWABLE_METHOD(XDrawString, void);
   DRAWABLE_METHOD(XDrawLine, void);
-
-  DISPLAY_METHOD(XSetForeground, void);
-  DISPLAY_METHOD(XSetFont, void);
-  DISPLAY_METHOD(XSetLineAttributes, void);
+  DRAWABLE_METHOD(XPutImage, void);
+
+  // How many state changes were sent to the server, and how many were
+  // dropped because the GC already held the requested value.
+  struct StateStats {
+    uint64_t foreground_sent = 0;
+    uint64_t foreground_elided = 0;
+    uint64_t line_attributes_sent = 0;
+    uint64_t line_attributes_elided = 0;
+    uint64_t font_sent = 0;
+    uint64_t font_elided = 0;
+    uint64_t clip_sent = 0;
+    uint64_t clip_elided = 0;
+  };
+
+  // Every Graphics in a tree shares one GC, so these track what the server
+  // last saw and skip requests that would not change anything.
+  void XSetForeground(unsigned long pixel);
+  void XSetFont(::Font font);
+  void XSetLineAttributes(uint width, int line_style, int cap, int join);
+  void XSetClipRectangles(int x, int y, const XRectangle* rects, int n);
+  void XClearClip();
+
+  const StateStats& GetStateStats() const;
 
   DISPLAY_METHOD_PASSTHROUGH(XLoadQueryFont, XFontStruct*);
   DISPLAY_METHOD_PASSTHROUGH(XFreeFont, void);
   DISPLAY_METHOD_PASSTHROUGH(XftFontClose, void);
   DISPLAY_METHOD_PASSTHROUGH(XftTextExtentsUtf8, void);
+  DISPLAY_METHOD_PASSTHROUGH(XftCharIndex, FT_UInt);
+  DISPLAY_METHOD_PASSTHROUGH(XftGlyphExtents, void);
+  DISPLAY_METHOD_PASSTHROUGH(XftDrawGlyphSpec, void);
+  DISPLAY_METHOD_PASSTHROUGH(GetFontCache, std::shared_ptr<XFontCache>);
 
   DISPLAY_METHOD_SCREEN(XftFontOpenName, XftFont*);
 
+  // Primitives drawn with the GC's current state commute with each other, so
+  // they are held back and sent as one request per primitive type when the
+  // state next changes, or when FlushQueued() is called at the end of a frame.
+  void QueueFillRectangle(int x, int y, uint w, uint h);
+  void QueueDrawRectangle(int x, int y, uint w, uint h);
+  void QueueFillArc(int x, int y, uint w, uint h, int angle1, int angle2);
+  void QueueDrawArc(int x, int y, uint w, uint h, int angle1, int angle2);
+  void QueueDrawLine(int x1, int y1, int x2, int y2);
+  void FlushQueued();
+
   void XCopyArea(Drawable src, int x, int y, uint w, uint h, int dx, int dy) {
+    FlushQueued();
     display_->XCopyArea(src, drawable_->Drawable(), graphics_, x, y, w, h, dx,
                         dy);
   }
 
-  XftDraw* XftDrawCreate() {
-    XVisualInfo vinfo;
-    display_->XMatchVisualInfo(display_->XDefaultScreen(), 32, TrueColor,
-                               &vinfo);
-    return drawable_->XftDrawCreate(vinfo.visual, colormap_->colormap());
+  // The colormap's shared XftDraw, pointed at this GC's drawable. Xft
+  // renders through XRender, so anything queued has to go out first.
+  XftDraw* GetXftDraw() {
+    FlushQueued();
+    return colormap_->GetXftDraw(drawable_->Drawable());
   }
 
   bool XftColorAllocValue(XRenderColor* color, XftColor* result) {
-    XVisualInfo vinfo;
-    display_->XMatchVisualInfo(display_->XDefaultScreen(), 32, TrueColor,
-                               &vinfo);
-    return display_->XftColorAllocValue(vinfo.visual, colormap_->colormap(),
-                                        color, result);
+    return display_->XftColorAllocValue(display_->GetARGBVisual().visual,
+                                        colormap_->colormap(), color, result);
   }
 
   void XftColorFree(XftColor* color) {
-    XVisualInfo vinfo;
-    display_->XMatchVisualInfo(display_->XDefaultScreen(), 32, TrueColor,
-                               &vinfo);
-    return display_->XftColorFree(vinfo.visual, colormap_->colormap(), color);
+    return display_->XftColorFree(display_->GetARGBVisual().visual,
+                                  colormap_->colormap(), color);
   }
 
   ::GC operator*();
@@ -89,6 +118,36 @@ class XGraphics {
   std::shared_ptr<XColorMap> colormap_;
   ::GC graphics_;
 
+  std::vector<XRectangle> fill_rectangles_;
+  std::vector<XRectangle> draw_rectangles_;
+  std::vector<XArc> fill_arcs_;
+  std::vector<XArc> draw_arcs_;
+  std::vector<XSegment> segments_;
+  bool has_queued_ = false;
+
+  // The server's view of the GC. Empty until this object first sets it.
+  struct LineAttributes {
+    uint width;
+    int line_style;
+    int cap;
+    int join;
+    bool operator==(const LineAttributes&) const = default;
+  };
+  struct Clip {
+    bool enabled;
+    int x;
+    int y;
+    std::vector<XRectangle> rects;
+  };
+  std::optional<unsigned long> foreground_;
+  std::optional<::Font> font_;
+  std::optional<LineAttributes> line_attributes_;
+  std::optional<Clip> clip_;
+  StateStats stats_;
+
+  // Set when the GC came from the display's pool, which takes it back.
+  std::optional<uint32_t> pool_depth_;
+
   // Private constructor. Must come from the display!
   XGraphics(::GC graphics,
             std::shared_ptr<XDrawable> drawable,
@@ -97,10 +156,10 @@ class XGraphics {
 
   // Allow XDrawable to create XGraphics
   friend struct Traits<XGraphics>;
+  friend class XDrawable;
 };
 
 #undef DRAWABLE_METHOD
-#undef DISPLAY_METHOD
 #undef DISPLAY_METHOD_PASSTHROUGH
 #undef DISPLAY_METHOD_SCREEN
 
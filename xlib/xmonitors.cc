@@ -0,0 +1,213 @@
+#include "xmonitors.h"
+
+#include <algorithm>
+
+#include "xdisplay.h"
+
+namespace xpp::xlib {
+
+namespace {
+
+constexpr float kMillimetersPerInch = 25.4f;
+
+// Works out the density of |monitor| from its pixel and physical sizes.
+// RandR reports the physical size unrotated, while the CRTC size already
+// is, so a quarter turn swaps them.
+void SetDensity(XMonitor* monitor, uint16_t rotation) {
+  uint32_t mm_width = monitor->mm_width;
+  uint32_t mm_height = monitor->mm_height;
+  if (rotation & (RR_Rotate_90 | RR_Rotate_270))
+    std::swap(mm_width, mm_height);
+  monitor->dpi_x =
+      mm_width ? monitor->size.width * kMillimetersPerInch / mm_width : 0;
+  monitor->dpi_y =
+      mm_height ? monitor->size.height * kMillimetersPerInch / mm_height : 0;
+}
+
+}  // namespace
+
+const XMonitor* XMonitorLayout::GetPrimary() const {
+  for (const XMonitor& monitor : monitors) {
+    if (monitor.primary)
+      return &monitor;
+  }
+  return monitors.empty() ? nullptr : &monitors.front();
+}
+
+const XMonitor* XMonitorLayout::Find(std::string_view name) const {
+  for (const XMonitor& monitor : monitors) {
+    if (monitor.name == name)
+      return &monitor;
+  }
+  return nullptr;
+}
+
+XMonitorTopology::XMonitorTopology(XDisplay* display)
+    : display_(display),
+      root_(display->XRootWindowRaw(display->XDefaultScreen())),
+      layout_(std::make_shared<const XMonitorLayout>()) {
+  int error_base;
+  if (display_->XRRQueryExtension(&event_base_, &error_base)) {
+    display_->XRRSelectInput(root_, RRScreenChangeNotifyMask |
+                                        RRCrtcChangeNotifyMask |
+                                        RROutputChangeNotifyMask);
+  } else {
+    event_base_ = -1;
+  }
+  Scan();
+}
+
+std::shared_ptr<const XMonitorLayout> XMonitorTopology::GetLayout() const {
+  return layout_.load(std::memory_order_acquire);
+}
+
+bool XMonitorTopology::HandleEvent(XEvent* event) {
+  if (event_base_ < 0)
+    return false;
+
+  if (event->type == event_base_ + RRScreenChangeNotify) {
+    // Only the root window size changed; the CRTC and output events that
+    // come with it carry the monitors.
+    XRRUpdateConfiguration(event);
+    return true;
+  }
+
+  if (event->type != event_base_ + RRNotify)
+    return false;
+
+  const auto* notify = reinterpret_cast<const XRRNotifyEvent*>(event);
+  if (notify->subtype == RRNotify_CrtcChange)
+    UpdateCrtc(*reinterpret_cast<const XRRCrtcChangeNotifyEvent*>(event));
+  else if (notify->subtype == RRNotify_OutputChange)
+    UpdateOutput(*reinterpret_cast<const XRROutputChangeNotifyEvent*>(event));
+  return true;
+}
+
+void XMonitorTopology::Scan() {
+  auto resources = display_->xcb_randr_get_screen_resources_current(root_);
+  auto primary = display_->xcb_randr_get_output_primary(root_);
+  if (!resources.Get())
+    return;
+
+  // Every output is asked about before any answer is read, and then every
+  // CRTC, so the whole scan is three round trips however many monitors
+  // there are.
+  const xcb_randr_output_t* outputs =
+      xcb_randr_get_screen_resources_current_outputs(resources.Get());
+  const int output_count =
+      xcb_randr_get_screen_resources_current_outputs_length(resources.Get());
+  const xcb_timestamp_t timestamp = resources->config_timestamp;
+
+  std::vector<decltype(display_->xcb_randr_get_output_info(0, 0))> infos;
+  infos.reserve(output_count);
+  for (int i = 0; i < output_count; i++)
+    infos.push_back(display_->xcb_randr_get_output_info(outputs[i], timestamp));
+
+  auto layout = std::make_shared<XMonitorLayout>();
+  std::vector<decltype(display_->xcb_randr_get_crtc_info(0, 0))> crtcs;
+  for (int i = 0; i < output_count; i++) {
+    auto& info = infos[i];
+    if (!info.Get() || info->connection != XCB_RANDR_CONNECTION_CONNECTED ||
+        !info->crtc) {
+      continue;
+    }
+    XMonitor monitor;
+    monitor.name.assign(
+        reinterpret_cast<const char*>(
+            xcb_randr_get_output_info_name(info.Get())),
+        xcb_randr_get_output_info_name_length(info.Get()));
+    monitor.output = outputs[i];
+    monitor.crtc = info->crtc;
+    monitor.mm_width = info->mm_width;
+    monitor.mm_height = info->mm_height;
+    monitor.primary = primary.Get() && primary->output == outputs[i];
+    layout->monitors.push_back(std::move(monitor));
+    crtcs.push_back(display_->xcb_randr_get_crtc_info(info->crtc, timestamp));
+  }
+
+  for (size_t i = 0; i < crtcs.size(); i++) {
+    XMonitor& monitor = layout->monitors[i];
+    if (auto* crtc = crtcs[i].Get()) {
+      monitor.position = {crtc->x, crtc->y};
+      monitor.size = {crtc->width, crtc->height};
+      SetDensity(&monitor, crtc->rotation);
+    }
+  }
+
+  std::lock_guard<std::mutex> lock(update_mutex_);
+  layout_.store(std::move(layout), std::memory_order_release);
+}
+
+void XMonitorTopology::UpdateCrtc(const XRRCrtcChangeNotifyEvent& event) {
+  std::lock_guard<std::mutex> lock(update_mutex_);
+  auto layout = std::make_shared<XMonitorLayout>(*GetLayout());
+  auto& monitors = layout->monitors;
+
+  // A CRTC without a mode has been turned off, along with its outputs.
+  if (!event.mode) {
+    std::erase_if(monitors, [&](const XMonitor& monitor) {
+      return monitor.crtc == event.crtc;
+    });
+  } else {
+    for (XMonitor& monitor : monitors) {
+      if (monitor.crtc != event.crtc)
+        continue;
+      monitor.position = {event.x, event.y};
+      monitor.size = {event.width, event.height};
+      SetDensity(&monitor, event.rotation);
+    }
+  }
+  layout_.store(std::move(layout), std::memory_order_release);
+}
+
+void XMonitorTopology::UpdateOutput(const XRROutputChangeNotifyEvent& event) {
+  const bool connected = event.connection == RR_Connected && event.crtc;
+
+  // The output's name and physical size aren't in the event, and the primary
+  // output may have moved, so those are asked for together.
+  std::optional<decltype(display_->xcb_randr_get_output_info(0, 0))> info;
+  std::optional<decltype(display_->xcb_randr_get_crtc_info(0, 0))> crtc;
+  auto primary = display_->xcb_randr_get_output_primary(root_);
+  if (connected) {
+    info.emplace(
+        display_->xcb_randr_get_output_info(event.output, XCB_CURRENT_TIME));
+    crtc.emplace(
+        display_->xcb_randr_get_crtc_info(event.crtc, XCB_CURRENT_TIME));
+  }
+
+  std::lock_guard<std::mutex> lock(update_mutex_);
+  auto layout = std::make_shared<XMonitorLayout>(*GetLayout());
+  auto& monitors = layout->monitors;
+  auto it = std::find_if(monitors.begin(), monitors.end(),
+                         [&](const XMonitor& monitor) {
+                           return monitor.output == event.output;
+                         });
+
+  if (!connected || !info->Get() || !crtc->Get()) {
+    if (it != monitors.end())
+      monitors.erase(it);
+  } else {
+    if (it == monitors.end())
+      it = monitors.insert(monitors.end(), XMonitor());
+    XMonitor& monitor = *it;
+    monitor.name.assign(
+        reinterpret_cast<const char*>(
+            xcb_randr_get_output_info_name(info->Get())),
+        xcb_randr_get_output_info_name_length(info->Get()));
+    monitor.output = event.output;
+    monitor.crtc = event.crtc;
+    monitor.mm_width = (*info)->mm_width;
+    monitor.mm_height = (*info)->mm_height;
+    monitor.position = {(*crtc)->x, (*crtc)->y};
+    monitor.size = {(*crtc)->width, (*crtc)->height};
+    SetDensity(&monitor, (*crtc)->rotation);
+  }
+
+  if (primary.Get()) {
+    for (XMonitor& monitor : monitors)
+      monitor.primary = monitor.output == primary->output;
+  }
+  layout_.store(std::move(layout), std::memory_order_release);
+}
+
+}  // namespace xpp::xlib
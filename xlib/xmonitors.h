@@ -0,0 +1,78 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <X11/Xlib.h>
+#include <X11/extensions/Xrandr.h>
+
+#include "xpp/gfx/coord.h"
+#include "xpp/gfx/rect.h"
+
+namespace xpp::xlib {
+
+class XDisplay;
+
+struct XMonitor {
+  std::string name;
+  RROutput output = 0;
+  RRCrtc crtc = 0;
+  gfx::Coord position = {0, 0};
+  gfx::Rect size = {0, 0};
+  // Physical size as the output reports it, and the density that works out
+  // to. Both are zero for outputs that don't know their size, like
+  // projectors and most virtual machines.
+  uint32_t mm_width = 0;
+  uint32_t mm_height = 0;
+  float dpi_x = 0;
+  float dpi_y = 0;
+  bool primary = false;
+};
+
+struct XMonitorLayout {
+  std::vector<XMonitor> monitors;
+
+  // The primary output, or the first one if none is marked primary. Null
+  // when nothing is connected.
+  const XMonitor* GetPrimary() const;
+  const XMonitor* Find(std::string_view name) const;
+};
+
+// The connected monitors of one display. They are scanned once, and after
+// that kept current from RandR change events, which HandleEvent() has to be
+// given. Reading the layout makes no request and never waits on a scan;
+// it copies a shared_ptr out of an atomic. That atomic isn't lock-free in
+// libstdc++, which holds an internal lock just for the copy, but readers
+// never wait on |update_mutex_|.
+class XMonitorTopology {
+ public:
+  // Subscribes to RandR changes on the root window and does the first scan.
+  explicit XMonitorTopology(XDisplay* display);
+
+  std::shared_ptr<const XMonitorLayout> GetLayout() const;
+
+  // Applies |event| if it is a RandR notification, and returns whether it
+  // was one.
+  bool HandleEvent(XEvent* event);
+
+ private:
+  void Scan();
+  void UpdateCrtc(const XRRCrtcChangeNotifyEvent& event);
+  void UpdateOutput(const XRROutputChangeNotifyEvent& event);
+
+  XDisplay* display_;
+  ::Window root_;
+  int event_base_ = -1;
+
+  // Writers copy the current layout, change the copy and swap it in.
+  std::mutex update_mutex_;
+  std::atomic<std::shared_ptr<const XMonitorLayout>> layout_;
+};
+
+}  // namespace xpp::xlib
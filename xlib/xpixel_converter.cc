@@ -0,0 +1,51 @@
+#include "xpixel_converter.h"
+
+namespace xpp::xlib {
+
+XPixelConverter::XPixelConverter(const Visual* visual) {
+  if (!visual || visual->c_class != TrueColor)
+    return;
+  direct_ = true;
+  red_ = FromMask(visual->red_mask);
+  green_ = FromMask(visual->green_mask);
+  blue_ = FromMask(visual->blue_mask);
+}
+
+bool XPixelConverter::IsDirect() const {
+  return direct_;
+}
+
+unsigned long XPixelConverter::Convert(uint16_t red,
+                                       uint16_t green,
+                                       uint16_t blue) const {
+  return red_.Place(red) | green_.Place(green) | blue_.Place(blue);
+}
+
+unsigned long XPixelConverter::Channel::Place(uint16_t value) const {
+  if (!bits)
+    return 0;
+  return ((static_cast<unsigned long>(value) >> (16 - bits)) << shift) & mask;
+}
+
+// static
+XPixelConverter::Channel XPixelConverter::FromMask(unsigned long mask) {
+  Channel channel;
+  channel.mask = mask;
+  if (!mask)
+    return channel;
+  while (!(mask & 1)) {
+    mask >>= 1;
+    channel.shift++;
+  }
+  while (mask & 1) {
+    mask >>= 1;
+    channel.bits++;
+  }
+  if (channel.bits > 16) {
+    channel.shift += channel.bits - 16;
+    channel.bits = 16;
+  }
+  return channel;
+}
+
+}  // namespace xpp::xlib
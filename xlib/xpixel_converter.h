@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstdint>
+
+#include <X11/Xlib.h>
+
+namespace xpp::xlib {
+
+// Computes pixel values straight from a TrueColor visual's channel masks,
+// the same way the server would answer XAllocColor, without the round trip.
+class XPixelConverter {
+ public:
+  explicit XPixelConverter(const Visual* visual);
+
+  // Only TrueColor visuals have a fixed mapping. Anything else has to go
+  // through the colormap.
+  bool IsDirect() const;
+
+  unsigned long Convert(uint16_t red, uint16_t green, uint16_t blue) const;
+
+ private:
+  struct Channel {
+    unsigned long mask = 0;
+    int shift = 0;
+    int bits = 0;
+
+    unsigned long Place(uint16_t value) const;
+  };
+
+  static Channel FromMask(unsigned long mask);
+
+  bool direct_ = false;
+  Channel red_;
+  Channel green_;
+  Channel blue_;
+};
+
+}  // namespace xpp::xlib
@@ -11,7 +11,10 @@ XPixmap::XPixmap(std::shared_ptr<XDisplay> display, ::Pixmap pixmap)
     : XDrawable(std::move(display)), pixmap_(pixmap) {}
 
 XPixmap::~XPixmap() {
-  display_->XFreePixmap(pixmap_);
+  if (pool_key_)
+    display_->GetResourcePool()->ReleasePixmap(pixmap_, *pool_key_);
+  else
+    display_->XFreePixmap(pixmap_);
 }
 
 ::Pixmap XPixmap::operator*() {
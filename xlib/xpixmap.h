@@ -1,10 +1,12 @@
 #pragma once
 
 #include <memory>
+#include <optional>
 
 #include "xdisplay.h"
 #include "xdrawable.h"
 #include "xorg_typemap.h"
+#include "xresource_pool.h"
 
 namespace xpp::xlib {
 
@@ -16,9 +18,12 @@ class XPixmap : public XDrawable {
 
  private:
   friend struct Traits<XPixmap>;
+  friend class XDisplay;
   XPixmap(std::shared_ptr<XDisplay>, ::Pixmap);
 
   ::Pixmap pixmap_;
+  // Set when the pixmap came from the display's pool, which takes it back.
+  std::optional<XResourcePool::PixmapKey> pool_key_;
 };
 
 }  // namespace xpp::xlib
\ No newline at end of file
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <cstdlib>
+#include <memory>
+#include <optional>
+
+#include <xcb/xcb.h>
+
+#include "xstats.h"
+
+namespace xpp::xlib {
+
+// The pending reply to one XCB request. The request is on its way as soon
+// as this exists; Get() only blocks if the reply hasn't arrived yet, so
+// making several requests before asking for any of their replies costs one
+// round trip instead of one each. A reply nobody asked for is discarded.
+template <typename Cookie, typename Reply>
+class XReply {
+ public:
+  using Fetch = Reply* (*)(xcb_connection_t*, Cookie, xcb_generic_error_t**);
+
+  // With |stats|, the wait in Get() is counted in |slot|.
+  XReply(xcb_connection_t* connection,
+         Cookie cookie,
+         Fetch fetch,
+         XProtocolStats* stats = nullptr,
+         size_t slot = 0)
+      : connection_(connection),
+        cookie_(cookie),
+        fetch_(fetch),
+        stats_(stats),
+        slot_(slot) {}
+
+  XReply(XReply&& other) noexcept
+      : connection_(other.connection_),
+        cookie_(other.cookie_),
+        fetch_(other.fetch_),
+        stats_(other.stats_),
+        slot_(other.slot_),
+        reply_(std::move(other.reply_)) {
+    other.fetch_ = nullptr;
+  }
+
+  XReply(const XReply&) = delete;
+  XReply& operator=(const XReply&) = delete;
+  XReply& operator=(XReply&&) = delete;
+
+  ~XReply() {
+    if (fetch_)
+      xcb_discard_reply(connection_, cookie_.sequence);
+  }
+
+  // Null if the server answered with an error.
+  const Reply* Get() {
+    if (fetch_) {
+      std::optional<XProtocolStats::Scope> scope;
+      if (stats_)
+        scope.emplace(stats_, slot_);
+      xcb_generic_error_t* error = nullptr;
+      reply_.reset(fetch_(connection_, cookie_, &error));
+      std::free(error);
+      fetch_ = nullptr;
+    }
+    return reply_.get();
+  }
+
+  const Reply* operator->() { return Get(); }
+
+ private:
+  struct Free {
+    void operator()(Reply* reply) const { std::free(reply); }
+  };
+
+  xcb_connection_t* connection_;
+  Cookie cookie_;
+  Fetch fetch_;
+  XProtocolStats* stats_;
+  size_t slot_;
+  std::unique_ptr<Reply, Free> reply_;
+};
+
+template <typename Cookie, typename Reply>
+XReply<Cookie, Reply> MakeXReply(
+    xcb_connection_t* connection,
+    Cookie cookie,
+    Reply* (*fetch)(xcb_connection_t*, Cookie, xcb_generic_error_t**),
+    XProtocolStats* stats = nullptr,
+    size_t slot = 0) {
+  return XReply<Cookie, Reply>(connection, cookie, fetch, stats, slot);
+}
+
+}  // namespace xpp::xlib
@@ -0,0 +1,152 @@
+#include "xresource_pool.h"
+
+#include <algorithm>
+
+#include "xdisplay.h"
+
+namespace xpp::xlib {
+
+namespace {
+
+// Small canvases come in many sizes, so they are bucketed finely; large
+// ones are few and would waste too much memory rounded as coarsely.
+uint32_t RoundToBucket(uint32_t length) {
+  const uint32_t step = length <= 1024 ? 64 : 256;
+  return std::max<uint32_t>((length + step - 1) / step * step, step);
+}
+
+}  // namespace
+
+XResourcePool::XResourcePool(XDisplay* display,
+                             size_t byte_budget,
+                             uint32_t max_idle_frames)
+    : display_(display),
+      byte_budget_(byte_budget),
+      max_idle_frames_(max_idle_frames) {}
+
+XResourcePool::~XResourcePool() {
+  for (const IdlePixmap& idle : pixmaps_)
+    display_->XFreePixmap(idle.pixmap);
+  for (const IdleGC& idle : gcs_)
+    display_->XFreeGC(idle.gc);
+}
+
+// static
+XResourcePool::PixmapKey XResourcePool::GetPixmapKey(uint32_t width,
+                                                     uint32_t height,
+                                                     uint32_t depth) {
+  return {depth, RoundToBucket(width), RoundToBucket(height)};
+}
+
+// static
+size_t XResourcePool::GetBytes(const PixmapKey& key) {
+  const size_t bytes_per_pixel = key.depth > 16 ? 4 : key.depth > 8 ? 2 : 1;
+  return size_t{key.width} * key.height * bytes_per_pixel;
+}
+
+::Pixmap XResourcePool::AcquirePixmap(::Drawable drawable,
+                                      const PixmapKey& key) {
+  {
+    std::lock_guard<std::mutex> lock(lock_);
+    auto it = std::find_if(
+        pixmaps_.begin(), pixmaps_.end(),
+        [&](const IdlePixmap& idle) { return idle.key == key; });
+    if (it != pixmaps_.end()) {
+      ::Pixmap pixmap = it->pixmap;
+      stats_.idle_bytes -= GetBytes(key);
+      pixmaps_.erase(it);
+      stats_.pixmaps_reused++;
+      return pixmap;
+    }
+    stats_.pixmaps_created++;
+  }
+  return display_->XCreatePixmapRaw(drawable, key.width, key.height,
+                                   key.depth);
+}
+
+void XResourcePool::ReleasePixmap(::Pixmap pixmap, const PixmapKey& key) {
+  std::lock_guard<std::mutex> lock(lock_);
+  pixmaps_.push_front({pixmap, key, frame_});
+  stats_.idle_bytes += GetBytes(key);
+  FreeOverBudget();
+}
+
+::GC XResourcePool::AcquireGC(::Drawable drawable, uint32_t depth) {
+  {
+    std::lock_guard<std::mutex> lock(lock_);
+    auto it = std::find_if(gcs_.begin(), gcs_.end(), [&](const IdleGC& idle) {
+      return idle.depth == depth;
+    });
+    if (it != gcs_.end()) {
+      ::GC gc = it->gc;
+      gcs_.erase(it);
+      stats_.gcs_reused++;
+      return gc;
+    }
+    stats_.gcs_created++;
+  }
+  return display_->XCreateGC(drawable, 0, nullptr);
+}
+
+void XResourcePool::ReleaseGC(::GC gc, uint32_t depth) {
+  // The next owner starts out assuming nothing was ever set, so whatever
+  // this one left behind has to go. The font can't be put back, but every
+  // owner sets one before drawing text.
+  XGCValues values = {};
+  values.foreground = 0;
+  values.line_width = 0;
+  values.line_style = LineSolid;
+  values.cap_style = CapButt;
+  values.join_style = JoinMiter;
+  values.clip_mask = None;
+  values.clip_x_origin = 0;
+  values.clip_y_origin = 0;
+  display_->XChangeGC(gc,
+                      GCForeground | GCLineWidth | GCLineStyle | GCCapStyle |
+                          GCJoinStyle | GCClipMask | GCClipXOrigin |
+                          GCClipYOrigin,
+                      &values);
+
+  std::lock_guard<std::mutex> lock(lock_);
+  gcs_.push_front({gc, depth, frame_});
+}
+
+void XResourcePool::Trim() {
+  std::lock_guard<std::mutex> lock(lock_);
+  frame_++;
+  const auto expired = [&](uint64_t released) {
+    return frame_ - released > max_idle_frames_;
+  };
+
+  // Both lists are in release order, so the expired ones are at the back.
+  while (!pixmaps_.empty() && expired(pixmaps_.back().released)) {
+    stats_.idle_bytes -= GetBytes(pixmaps_.back().key);
+    display_->XFreePixmap(pixmaps_.back().pixmap);
+    pixmaps_.pop_back();
+    stats_.pixmaps_freed++;
+  }
+  while (!gcs_.empty() && expired(gcs_.back().released)) {
+    display_->XFreeGC(gcs_.back().gc);
+    gcs_.pop_back();
+    stats_.gcs_freed++;
+  }
+}
+
+void XResourcePool::FreeOverBudget() {
+  while (stats_.idle_bytes > byte_budget_ && !pixmaps_.empty()) {
+    stats_.idle_bytes -= GetBytes(pixmaps_.back().key);
+    display_->XFreePixmap(pixmaps_.back().pixmap);
+    pixmaps_.pop_back();
+    stats_.pixmaps_freed++;
+  }
+}
+
+XResourcePool::Stats XResourcePool::GetStats() const {
+  std::lock_guard<std::mutex> lock(lock_);
+  Stats stats = stats_;
+  stats.idle_pixmaps = pixmaps_.size();
+  stats.idle_gcs = gcs_.size();
+  return stats;
+}
+
+}  // namespace xpp::xlib
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <cstdint>
+#include <list>
+#include <mutex>
+
+#include <X11/Xlib.h>
+
+namespace xpp::xlib {
+
+class XDisplay;
+
+// Offscreen pixmaps and GCs of one display, kept around after use so the
+// next canvas can take them instead of asking the server for new ones.
+// Pixmaps are matched by depth and by size rounded up to a bucket, GCs by
+// the depth they draw at. Idle pixmaps are held to |byte_budget|, least
+// recently used going first, and anything idle for |max_idle_frames| frames
+// is freed by Trim(). Every request goes through |display|'s wrappers, so
+// it shows up in the protocol stats.
+class XResourcePool {
+ public:
+  struct Stats {
+    uint64_t pixmaps_created = 0;
+    uint64_t pixmaps_reused = 0;
+    uint64_t pixmaps_freed = 0;
+    uint64_t gcs_created = 0;
+    uint64_t gcs_reused = 0;
+    uint64_t gcs_freed = 0;
+    size_t idle_pixmaps = 0;
+    size_t idle_bytes = 0;
+    size_t idle_gcs = 0;
+  };
+
+  struct PixmapKey {
+    uint32_t depth;
+    uint32_t width;
+    uint32_t height;
+    bool operator==(const PixmapKey&) const = default;
+  };
+
+  XResourcePool(XDisplay* display,
+                size_t byte_budget = 64 << 20,
+                uint32_t max_idle_frames = 120);
+
+  // Frees everything idle. Resources still in use are freed by their owners.
+  ~XResourcePool();
+
+  // The key a pixmap of |width| x |height| is pooled under. The pixmap is
+  // made at the key's size, which may be larger than asked for.
+  static PixmapKey GetPixmapKey(uint32_t width,
+                                uint32_t height,
+                                uint32_t depth);
+
+  // |drawable| only picks the screen. Released resources are handed out
+  // again, so only ever release something once.
+  ::Pixmap AcquirePixmap(::Drawable drawable, const PixmapKey& key);
+  void ReleasePixmap(::Pixmap pixmap, const PixmapKey& key);
+
+  // |drawable| must have |depth|. A released GC is put back to its default
+  // state, apart from its font, before anyone else gets it.
+  ::GC AcquireGC(::Drawable drawable, uint32_t depth);
+  void ReleaseGC(::GC gc, uint32_t depth);
+
+  // Ages the idle resources by a frame and frees the ones that have been
+  // idle for too long.
+  void Trim();
+
+  Stats GetStats() const;
+
+ private:
+  struct IdlePixmap {
+    ::Pixmap pixmap;
+    PixmapKey key;
+    uint64_t released;
+  };
+
+  struct IdleGC {
+    ::GC gc;
+    uint32_t depth;
+    uint64_t released;
+  };
+
+  static size_t GetBytes(const PixmapKey& key);
+
+  // Expects |lock_| to be held.
+  void FreeOverBudget();
+
+  // Owns the pool.
+  XDisplay* display_;
+  size_t byte_budget_;
+  uint32_t max_idle_frames_;
+
+  // Canvases can be dropped from the render thread.
+  mutable std::mutex lock_;
+  // Most recently released first.
+  std::list<IdlePixmap> pixmaps_;
+  std::list<IdleGC> gcs_;
+  uint64_t frame_ = 0;
+  Stats stats_;
+};
+
+}  // namespace xpp::xlib
@@ -0,0 +1,149 @@
+#include "xstats.h"
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstdlib>
+
+namespace xpp::xlib {
+
+namespace {
+
+// Calls that block until the server replies. Everything else is queued by
+// Xlib and sent with the next flush. XCB requests only send; the wait is
+// counted when their XReply is collected, under the name of the _reply
+// function.
+constexpr std::string_view kRoundTrips[] = {
+    "XAllocColor",
+    "XInternAtom",
+    "XLoadQueryFont",
+    "XRRQueryExtension",
+    "XftFontOpenName",
+    "xcb_intern_atom_reply",
+    "xcb_randr_get_crtc_info_reply",
+    "xcb_randr_get_output_info_reply",
+    "xcb_randr_get_output_primary_reply",
+    "xcb_randr_get_screen_resources_current_reply",
+};
+
+struct Registry {
+  std::mutex mutex;
+  std::array<const char*, XProtocolStats::kMaxFunctions> names = {};
+  size_t size = 0;
+};
+
+Registry& GetRegistry() {
+  static Registry registry;
+  return registry;
+}
+
+bool IsRoundTrip(std::string_view name) {
+  return std::find(std::begin(kRoundTrips), std::end(kRoundTrips), name) !=
+         std::end(kRoundTrips);
+}
+
+}  // namespace
+
+XProtocolStats::XProtocolStats() {
+  if (const char* interval = std::getenv("XPP_X_STATS_DUMP"))
+    dump_interval_ = std::strtoul(interval, nullptr, 10);
+}
+
+// static
+size_t XProtocolStats::Register(const char* name) {
+  Registry& registry = GetRegistry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  for (size_t i = 0; i < registry.size; i++) {
+    if (std::string_view(registry.names[i]) == name)
+      return i;
+  }
+  // Past the limit, everything shares the last slot.
+  if (registry.size == kMaxFunctions)
+    return kMaxFunctions - 1;
+  registry.names[registry.size] = name;
+  return registry.size++;
+}
+
+void XProtocolStats::Add(size_t slot, Clock::duration elapsed) {
+  current_[slot].count.fetch_add(1, std::memory_order_relaxed);
+  current_[slot].nanoseconds.fetch_add(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count(),
+      std::memory_order_relaxed);
+}
+
+void XProtocolStats::EndFrame() {
+  Registry& registry = GetRegistry();
+  std::array<const char*, kMaxFunctions> names;
+  {
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    names = registry.names;
+  }
+
+  bool dump;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Frame frame = {frame_index_++, 0, 0, {}};
+    for (size_t i = 0; i < kMaxFunctions; i++) {
+      uint64_t count = current_[i].count.exchange(0, std::memory_order_relaxed);
+      if (!count)
+        continue;
+      uint64_t nanoseconds =
+          current_[i].nanoseconds.exchange(0, std::memory_order_relaxed);
+      bool round_trip = IsRoundTrip(names[i]);
+
+      Call& total = totals_[i];
+      total.name = names[i];
+      total.round_trip = round_trip;
+      total.count += count;
+      total.nanoseconds += nanoseconds;
+
+      frame.calls.push_back({names[i], round_trip, count, nanoseconds});
+      frame.nanoseconds += nanoseconds;
+      if (round_trip)
+        frame.round_trips += count;
+    }
+
+    frames_.push_back(std::move(frame));
+    if (frames_.size() > kFrameHistory)
+      frames_.pop_front();
+    dump = dump_interval_ && frame_index_ % dump_interval_ == 0;
+  }
+
+  if (dump)
+    Dump(stderr);
+}
+
+void XProtocolStats::SetDumpInterval(uint32_t frames) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  dump_interval_ = frames;
+}
+
+void XProtocolStats::Dump(FILE* out) const {
+  Snapshot snapshot = GetSnapshot();
+  std::sort(snapshot.totals.begin(), snapshot.totals.end(),
+            [](const Call& a, const Call& b) {
+              return a.nanoseconds > b.nanoseconds;
+            });
+
+  uint64_t frames = snapshot.frames.empty()
+                        ? 0
+                        : snapshot.frames.back().index + 1;
+  fprintf(out, "X requests after %" PRIu64 " frames:\n", frames);
+  for (const Call& call : snapshot.totals) {
+    fprintf(out, "  %-32s %10" PRIu64 " calls %12.3f ms%s\n", call.name,
+            call.count,
+            call.nanoseconds / 1e6, call.round_trip ? "  round trip" : "");
+  }
+}
+
+XProtocolStats::Snapshot XProtocolStats::GetSnapshot() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  Snapshot snapshot;
+  for (const Call& call : totals_) {
+    if (call.count)
+      snapshot.totals.push_back(call);
+  }
+  snapshot.frames = frames_;
+  return snapshot;
+}
+
+}  // namespace xpp::xlib
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <mutex>
+#include <string_view>
+#include <vector>
+
+namespace xpp::xlib {
+
+// Per-request accounting for everything sent through XDisplay. It is only
+// compiled in when XPP_X_STATS is defined; otherwise the hooks in the
+// wrapper macros expand to nothing and XDisplay::GetStats() stays empty.
+class XProtocolStats {
+ public:
+  struct Call {
+    const char* name;
+    // Whether the call waits for a reply from the server.
+    bool round_trip;
+    uint64_t count;
+    uint64_t nanoseconds;
+  };
+
+  struct Frame {
+    uint64_t index;
+    uint64_t round_trips;
+    uint64_t nanoseconds;
+    std::vector<Call> calls;
+  };
+
+  struct Snapshot {
+    std::vector<Call> totals;
+    // The most recent frames, oldest first.
+    std::deque<Frame> frames;
+  };
+
+  // Times one call and adds it to the current frame.
+  class Scope {
+   public:
+    Scope(XProtocolStats* stats, size_t slot)
+        : stats_(stats), slot_(slot), start_(Clock::now()) {}
+    ~Scope() { stats_->Add(slot_, Clock::now() - start_); }
+
+   private:
+    XProtocolStats* stats_;
+    size_t slot_;
+    std::chrono::steady_clock::time_point start_;
+  };
+
+  static constexpr size_t kMaxFunctions = 128;
+  static constexpr size_t kFrameHistory = 120;
+
+  // Dumps every |XPP_X_STATS_DUMP| frames when that is set in the
+  // environment.
+  XProtocolStats();
+
+  // Gives |name| a slot shared by every display. Meant to be called once per
+  // call site and kept in a function-local static.
+  static size_t Register(const char* name);
+
+  // Closes the current frame, and dumps the totals if the dump interval has
+  // come around.
+  void EndFrame();
+  void SetDumpInterval(uint32_t frames);
+  void Dump(FILE* out) const;
+
+  Snapshot GetSnapshot() const;
+
+ private:
+  using Clock = std::chrono::steady_clock;
+
+  struct Counter {
+    std::atomic<uint64_t> count{0};
+    std::atomic<uint64_t> nanoseconds{0};
+  };
+
+  void Add(size_t slot, Clock::duration elapsed);
+
+  std::array<Counter, kMaxFunctions> current_;
+
+  mutable std::mutex mutex_;
+  std::array<Call, kMaxFunctions> totals_ = {};
+  std::deque<Frame> frames_;
+  uint64_t frame_index_ = 0;
+  uint32_t dump_interval_ = 0;
+};
+
+}  // namespace xpp::xlib
@@ -23,9 +23,10 @@ XWindow::XWindow(std::shared_ptr<XDisplay> display,
 Traits<XColorMap>::XppType Traits<XColorMap>::Import(
     const XorgType& colormap,
     std::shared_ptr<XWindow> window,
-    std::shared_ptr<XDisplay> display) {
+    std::shared_ptr<XDisplay> display,
+    Visual* visual) {
   return std::shared_ptr<XColorMap>(
-      new XColorMap(colormap, std::move(window), std::move(display)));
+      new XColorMap(colormap, std::move(window), std::move(display), visual));
 }
 
 ::Window XWindow::operator*() {
@@ -19,28 +19,27 @@ namespace xpp::xlib {
     return display_->fn(window_, std::forward<Args>(args)...); \
   }
 
-#define CONVERT_RETURN(fn, traits, ...)                                      \
-  template <typename... Args>                                                \
-  traits::XppType fn(Args&&... args) {                                       \
-    auto pre_converted = display_->fn(window_, std::forward<Args>(args)...); \
-    std::shared_ptr<XWindow> w =                                             \
-        std::static_pointer_cast<XWindow>(shared_from_this());               \
-    return traits::Import(pre_converted, std::move(w), ##__VA_ARGS__);       \
-  }
-
 template <>
 struct Traits<XColorMap> {
   using XppType = std::shared_ptr<XColorMap>;
   using XorgType = ::Colormap;
   static XppType Import(const XorgType& colormap,
                         std::shared_ptr<XWindow> window,
-                        std::shared_ptr<XDisplay> display);
+                        std::shared_ptr<XDisplay> display,
+                        Visual* visual);
 };
 
 class XWindow : public XDrawable {
  public:
   ~XWindow() override;
-  CONVERT_RETURN(XCreateColormap, Traits<XColorMap>, display_);
+
+  // The colormap remembers |visual| so it can compute pixels locally.
+  Traits<XColorMap>::XppType XCreateColormap(Visual* visual, int alloc) {
+    return Traits<XColorMap>::Import(
+        display_->XCreateColormap(window_, visual, alloc),
+        std::static_pointer_cast<XWindow>(shared_from_this()), display_,
+        visual);
+  }
 
   NO_CONVERSIONS(XCreatePixmap, auto);
   NO_CONVERSIONS(XCreateWindow, auto);